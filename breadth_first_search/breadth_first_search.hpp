@@ -4,6 +4,9 @@
 #include <vector>
 
 #include <iostream>
+
+#include "graph_stats.hpp"
+
 namespace xtd {
 
 template<template <typename, typename> typename Graph, typename N, typename E>
@@ -15,6 +18,7 @@ auto breadth_first_search(Graph<N, E> const& graph, N const& from, N const& to)
 
     auto search_queue = std::queue<std::pair<N, std::vector<N>>>();
     search_queue.push(std::make_pair(from, current_path));
+    XTD_GRAPH_STATS_FRONTIER(0, 1);
 
     while (!search_queue.empty()) {
         auto const [current_node, current_path] = search_queue.front();
@@ -25,7 +29,15 @@ auto breadth_first_search(Graph<N, E> const& graph, N const& from, N const& to)
             paths.push_back(current_path);
         }
 
-        for (auto const& adjacent_node : graph.connections(current_node)) {
+        auto const adjacent_nodes = [&] {
+            XTD_GRAPH_STATS_PHASE("connections");
+            return graph.connections(current_node);
+        }();
+
+        XTD_GRAPH_STATS_PHASE("enqueue");
+        XTD_GRAPH_STATS_FRONTIER(current_path.size(), adjacent_nodes.size());
+        XTD_GRAPH_STATS_ADD(allocations, adjacent_nodes.size());
+        for (auto const& adjacent_node : adjacent_nodes) {
             auto new_path = std::vector<N>(current_path);
             new_path.emplace_back(adjacent_node);
             search_queue.push(std::make_pair(adjacent_node, new_path));
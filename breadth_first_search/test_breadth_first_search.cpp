@@ -1,3 +1,10 @@
+#define XTD_GRAPH_STATS
+
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "breadth_first_search.hpp"
 #include "directed_weighted_graph.hpp"
 #include "gtest/gtest.h"
@@ -48,4 +55,55 @@ TEST(breadth_first_search, forest) {
     ASSERT_TRUE(g.insert_edge(3, 4, "a"));
     auto v = xtd::breadth_first_search(g, 1, 4);
     EXPECT_TRUE(v.empty());
-}
\ No newline at end of file
+}
+
+TEST(breadth_first_search, stats) {
+    auto g = xtd::directed_weighted_graph<int, std::string>({1, 2, 3, 4});
+    ASSERT_TRUE(g.insert_edge(1, 2, "a"));
+    ASSERT_TRUE(g.insert_edge(1, 3, "a"));
+    ASSERT_TRUE(g.insert_edge(2, 4, "a"));
+    ASSERT_TRUE(g.insert_edge(3, 4, "a"));
+    xtd::graph_stats::reset_local();
+    auto v = xtd::breadth_first_search(g, 1, 4);
+    EXPECT_EQ(2, v.size());
+    auto const stats = xtd::graph_stats::local();
+    EXPECT_EQ(std::vector<std::size_t>({1, 2, 2}), stats.frontier_sizes);
+    EXPECT_EQ(4, stats.edges_scanned);
+    EXPECT_LT(0, stats.node_lookups);
+    EXPECT_LT(0, stats.weak_ptr_locks);
+    EXPECT_LT(0, stats.allocations);
+    EXPECT_TRUE(stats.phase_times.contains("connections"));
+    EXPECT_TRUE(stats.phase_times.contains("enqueue"));
+}
+
+TEST(breadth_first_search, stats_from_another_thread) {
+    auto g = xtd::directed_weighted_graph<int, std::string>({1, 2, 3, 4});
+    ASSERT_TRUE(g.insert_edge(1, 2, "a"));
+    ASSERT_TRUE(g.insert_edge(1, 3, "a"));
+    ASSERT_TRUE(g.insert_edge(2, 4, "a"));
+    ASSERT_TRUE(g.insert_edge(3, 4, "a"));
+    xtd::graph_stats::reset_total();
+
+    // The worker keeps running until its counters have been read, so they are read while live.
+    auto searched = std::promise<void>();
+    auto read = std::promise<void>();
+    auto worker = std::thread([&] {
+        xtd::breadth_first_search(g, 1, 4);
+        searched.set_value();
+        read.get_future().wait();
+    });
+    searched.get_future().wait();
+    auto const live = xtd::graph_stats::total();
+    read.set_value();
+    worker.join();
+
+    EXPECT_EQ(std::vector<std::size_t>({1, 2, 2}), live.frontier_sizes);
+    EXPECT_EQ(4, live.edges_scanned);
+    EXPECT_TRUE(live.phase_times.contains("enqueue"));
+    EXPECT_EQ(0, xtd::graph_stats::local().edges_scanned);
+
+    // Counters of threads that have exited are still counted.
+    auto const retired = xtd::graph_stats::total();
+    EXPECT_EQ(4, retired.edges_scanned);
+    EXPECT_EQ(live.frontier_sizes, retired.frontier_sizes);
+}
@@ -0,0 +1,204 @@
+#include <coroutine>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "circular_queue.hpp"
+
+#pragma once
+
+// Bounded queue for coroutines: co_await queue.push(item) and co_await queue.pop() suspend the
+// calling coroutine, rather than spinning or blocking its thread, until the operation can complete.
+//
+// With Overflow::block a push into a full queue suspends until a pop makes room. With the other
+// policies it completes immediately, either overwriting the oldest element or resolving to false.
+// A pop from an empty queue always suspends until a push or close().
+//
+// The queue may be shared between threads. A suspended coroutine is resumed on the thread that
+// performs the matching operation, from within that call, and waiters are served in FIFO order.
+template <typename T, size_t capacity_, Overflow overflow_ = Overflow::block>
+class AsyncCircularQueue {
+public:
+    class PushAwaiter;
+    class PopAwaiter;
+
+    AsyncCircularQueue() = default;
+    AsyncCircularQueue(AsyncCircularQueue const&) = delete;
+    auto operator=(AsyncCircularQueue const&) -> AsyncCircularQueue& = delete;
+
+    // Awaiting the result resolves to true once the item is queued or handed to a waiting pop, and
+    // to false if it was rejected or the queue is closed.
+    auto push(T item) -> PushAwaiter { return {*this, std::move(item)}; }
+
+    // Awaiting the result resolves to the oldest item, or to nullopt once the queue is closed and
+    // drained.
+    auto pop() -> PopAwaiter { return PopAwaiter(*this); }
+
+    // Non-suspending variants for producers and consumers that are not coroutines. With
+    // Overflow::block, try_push fails instead of waiting.
+    auto try_push(T item) -> bool {
+        std::unique_lock lock(mutex);
+        if (closed || (items.full() && overflow_ != Overflow::overwrite)) return false;
+        auto* popper = deliver(std::move(item));
+        lock.unlock();
+        resume(popper);
+        return true;
+    }
+
+    auto try_pop() -> std::optional<T> {
+        std::optional<T> result;
+        std::unique_lock lock(mutex);
+        if (items.empty()) return result;
+        auto* pusher = take(result);
+        lock.unlock();
+        resume(pusher);
+        return result;
+    }
+
+    // Fails all pending and future pushes. Pops drain the remaining items, then resolve to nullopt.
+    auto close() -> void {
+        std::unique_lock lock(mutex);
+        closed = true;
+        auto* pusher = std::exchange(pushers, {}).head;
+        auto* popper = std::exchange(poppers, {}).head;
+        lock.unlock();
+        // Each waiter is unlinked before it is resumed, as resuming may destroy it.
+        while (pusher != nullptr) resume(std::exchange(pusher, pusher->next));
+        while (popper != nullptr) resume(std::exchange(popper, popper->next));
+    }
+
+    auto empty() const -> bool {
+        std::lock_guard lock(mutex);
+        return items.empty();
+    }
+
+    auto size() const -> size_t {
+        std::lock_guard lock(mutex);
+        return items.size();
+    }
+
+    auto capacity() const -> size_t { return capacity_; }
+
+    class PushAwaiter {
+    public:
+        friend class AsyncCircularQueue;
+
+        auto await_ready() const -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> awaiting) -> bool {
+            std::unique_lock lock(queue.mutex);
+            if (queue.closed) return false;
+            if (queue.items.full() && overflow_ != Overflow::overwrite) {
+                if constexpr (overflow_ == Overflow::block) {
+                    handle = awaiting;
+                    queue.pushers.append(this);
+                    return true;
+                }
+                return false;
+            }
+            auto* popper = queue.deliver(std::move(item));
+            accepted = true;
+            lock.unlock();
+            resume(popper);
+            return false;
+        }
+
+        auto await_resume() const -> bool { return accepted; }
+
+    private:
+        PushAwaiter(AsyncCircularQueue& queue, T item) : queue(queue), item(std::move(item)) {}
+
+        AsyncCircularQueue& queue;
+        T item;
+        bool accepted = false;
+        std::coroutine_handle<> handle;
+        PushAwaiter* next = nullptr;
+    };
+
+    class PopAwaiter {
+    public:
+        friend class AsyncCircularQueue;
+
+        auto await_ready() const -> bool { return false; }
+
+        auto await_suspend(std::coroutine_handle<> awaiting) -> bool {
+            std::unique_lock lock(queue.mutex);
+            if (queue.items.empty()) {
+                if (queue.closed) return false;
+                handle = awaiting;
+                queue.poppers.append(this);
+                return true;
+            }
+            auto* pusher = queue.take(result);
+            lock.unlock();
+            resume(pusher);
+            return false;
+        }
+
+        auto await_resume() -> std::optional<T> { return std::move(result); }
+
+    private:
+        explicit PopAwaiter(AsyncCircularQueue& queue) : queue(queue) {}
+
+        AsyncCircularQueue& queue;
+        std::optional<T> result;
+        std::coroutine_handle<> handle;
+        PopAwaiter* next = nullptr;
+    };
+
+private:
+    // Intrusive FIFO of suspended awaiters, which live in their coroutines' frames.
+    template <typename Awaiter>
+    struct WaitList {
+        auto append(Awaiter* awaiter) -> void {
+            (tail != nullptr ? tail->next : head) = awaiter;
+            tail = awaiter;
+        }
+
+        auto take() -> Awaiter* {
+            auto* awaiter = head;
+            if (awaiter != nullptr && (head = awaiter->next) == nullptr) tail = nullptr;
+            return awaiter;
+        }
+
+        Awaiter* head = nullptr;
+        Awaiter* tail = nullptr;
+    };
+
+    // Hands item straight to the first waiting pop, or queues it, overwriting the oldest item if the
+    // queue is full. Returns the pop to resume once the lock is released.
+    auto deliver(T&& item) -> PopAwaiter* {
+        auto* popper = poppers.take();
+        if (popper != nullptr) {
+            popper->result.emplace(std::move(item));
+        } else {
+            items.push(std::move(item));
+        }
+        return popper;
+    }
+
+    // Moves the oldest item into result and lets the first waiting push into the freed slot. Returns
+    // the push to resume once the lock is released.
+    auto take(std::optional<T>& result) -> PushAwaiter* {
+        result.emplace(std::move(items.front()));
+        items.pop();
+        auto* pusher = pushers.take();
+        if (pusher != nullptr) {
+            items.push(std::move(pusher->item));
+            pusher->accepted = true;
+        }
+        return pusher;
+    }
+
+    template <typename Awaiter>
+    static auto resume(Awaiter* awaiter) -> void {
+        if (awaiter != nullptr) awaiter->handle.resume();
+    }
+
+    mutable std::mutex mutex;
+    CircularQueue<T, capacity_> items;
+    WaitList<PushAwaiter> pushers;  // Only non-empty while items is full.
+    WaitList<PopAwaiter> poppers;   // Only non-empty while items is empty.
+    bool closed = false;
+};
@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "async_circular_queue.hpp"
+#include "circular_queue.hpp"
+#include "dynamic_circular_queue.hpp"
+#include "mpmc_circular_queue.hpp"
+#include "spsc_circular_queue.hpp"
+
+// Throughput and latency of every CircularQueue variant:
+//  - single threaded push/pop throughput,
+//  - operator[] random access and iteration for the variants that support them,
+//  - cross-thread ping-pong round trip latency percentiles,
+//  - multi-producer/multi-consumer throughput under contention.
+
+constexpr size_t capacity = 1024;
+
+using Clock = std::chrono::steady_clock;
+
+// Stops the compiler from discarding a value that is computed only to be measured.
+template <typename T>
+auto doNotOptimise(T const& value) -> void {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Returns millions of operations per second for ops operations taking elapsed.
+auto rate(size_t ops, Clock::duration elapsed) -> double {
+    return ops / std::chrono::duration<double>(elapsed).count() / 1e6;
+}
+
+// Uniform non-blocking interface over the variants, for the shared benchmark loops.
+template <typename Queue>
+auto tryPush(Queue& queue, int item) -> bool {
+    if constexpr (requires { queue.try_push(item); }) {
+        return queue.try_push(item);
+    } else if constexpr (requires { queue.full(); }) {
+        return !queue.full() && queue.push(item);
+    } else {
+        return queue.push(item);
+    }
+}
+
+template <typename Queue>
+auto tryPop(Queue& queue, int& item) -> bool {
+    if constexpr (requires { queue.try_pop(item); }) {
+        return queue.try_pop(item);
+    } else if constexpr (requires { queue.try_pop(); }) {
+        auto popped = queue.try_pop();
+        if (popped) item = *popped;
+        return popped.has_value();
+    } else if constexpr (requires { { queue.pop(item) } -> std::same_as<bool>; }) {
+        return queue.pop(item);
+    } else {
+        if (queue.empty()) return false;
+        item = queue.front();
+        return queue.pop();
+    }
+}
+
+// A single threaded queue guarded by a mutex, with the same try/blocking interface as
+// MpmcCircularQueue.
+template <typename Queue>
+class Locked {
+public:
+    auto try_push(int item) -> bool {
+        std::lock_guard lock(mutex);
+        return tryPush(queue, item);
+    }
+
+    auto try_pop(int& item) -> bool {
+        std::lock_guard lock(mutex);
+        return tryPop(queue, item);
+    }
+
+    auto push(int item) -> void {
+        while (!try_push(item)) std::this_thread::yield();
+    }
+
+    auto pop(int& item) -> void {
+        while (!try_pop(item)) std::this_thread::yield();
+    }
+
+private:
+    std::mutex mutex;
+    Queue queue;
+};
+
+// Fills and drains queue repeatedly from one thread. Returns millions of push/pop pairs per second.
+template <typename Queue>
+auto pushPop(Queue& queue, size_t rounds) -> double {
+    int item = 0;
+    auto const start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (int i = 0; i < static_cast<int>(capacity); ++i) tryPush(queue, i);
+        for (size_t i = 0; i < capacity; ++i) tryPop(queue, item);
+        doNotOptimise(item);
+    }
+    return rate(rounds * capacity, Clock::now() - start);
+}
+
+// Returns millions of operator[] reads per second at random indices of a full, wrapped queue.
+template <typename Queue>
+auto randomAccess(Queue& queue, size_t reads) -> double {
+    for (size_t i = 0; i < capacity + capacity / 2; ++i) queue.push(static_cast<int>(i));
+    std::vector<size_t> indices(4096);
+    std::mt19937 random(42);
+    for (auto& i : indices) i = random() % queue.size();
+
+    long sum = 0;
+    auto const start = Clock::now();
+    for (size_t r = 0; r < reads; r += indices.size()) {
+        for (auto i : indices) sum += queue[i];
+    }
+    doNotOptimise(sum);
+    return rate(reads, Clock::now() - start);
+}
+
+// Returns millions of elements visited per second by range-for over a full, wrapped queue.
+template <typename Queue>
+auto iterate(Queue& queue, size_t rounds) -> double {
+    for (size_t i = 0; i < capacity + capacity / 2; ++i) queue.push(static_cast<int>(i));
+    long sum = 0;
+    auto const start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        for (auto e : queue) sum += e;
+        doNotOptimise(sum);
+    }
+    return rate(rounds * queue.size(), Clock::now() - start);
+}
+
+// As iterate, but summing the contiguous blocks from peek_spans, which the compiler can vectorise.
+template <typename Queue>
+auto iterateSpans(Queue& queue, size_t rounds) -> double {
+    for (size_t i = 0; i < capacity + capacity / 2; ++i) queue.push(static_cast<int>(i));
+    long sum = 0;
+    auto const start = Clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        auto [first, second] = queue.peek_spans();
+        for (auto e : first) sum += e;
+        for (auto e : second) sum += e;
+        doNotOptimise(sum);
+    }
+    return rate(rounds * queue.size(), Clock::now() - start);
+}
+
+// Spins until done() returns true, yielding the thread once spinning is unlikely to help, so that the
+// benchmark still makes progress when both threads share a core.
+template <typename Done>
+auto spinUntil(Done done) -> void {
+    for (int spins = 0; !done();) {
+        if (++spins > 4096) std::this_thread::yield();
+    }
+}
+
+struct Percentiles {
+    double p50, p99, p999;  // Nanoseconds.
+};
+
+// Bounces a message between two threads through a pair of queues and returns the round trip
+// latency percentiles. Both threads spin, so on separate cores this measures the handoff itself
+// rather than the scheduler.
+template <typename Queue>
+auto pingPong(size_t rounds) -> Percentiles {
+    auto ping = std::make_unique<Queue>();
+    auto pong = std::make_unique<Queue>();
+    constexpr size_t warmup = 1000;
+
+    std::thread echo([&] {
+        int item;
+        for (size_t i = 0; i < warmup + rounds; ++i) {
+            spinUntil([&] { return tryPop(*ping, item); });
+            spinUntil([&] { return tryPush(*pong, item); });
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(rounds);
+    int item;
+    for (size_t i = 0; i < warmup + rounds; ++i) {
+        auto const start = Clock::now();
+        spinUntil([&] { return tryPush(*ping, static_cast<int>(i)); });
+        spinUntil([&] { return tryPop(*pong, item); });
+        auto const elapsed = Clock::now() - start;
+        if (i >= warmup) samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count());
+    }
+    echo.join();
+
+    std::sort(samples.begin(), samples.end());
+    auto const at = [&](double q) { return samples[static_cast<size_t>(q * (samples.size() - 1))]; };
+    return {at(0.5), at(0.99), at(0.999)};
+}
+
+// Returns millions of messages per second moved through queue by threads producers and threads
+// consumers.
+template <typename Queue>
+auto contention(int threads, int messagesPerThread) -> double {
+    auto queue = std::make_unique<Queue>();
+    std::vector<std::thread> workers;
+    auto start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&queue, messagesPerThread] {
+            for (int i = 0; i < messagesPerThread; ++i) queue->push(i);
+        });
+        workers.emplace_back([&queue, messagesPerThread] {
+            int item;
+            for (int i = 0; i < messagesPerThread; ++i) queue->pop(item);
+        });
+    }
+    for (auto& w : workers) w.join();
+    return rate(static_cast<size_t>(threads) * messagesPerThread, Clock::now() - start);
+}
+
+// DynamicCircularQueue needs its capacity at construction, so the generic benchmarks construct
+// this subclass instead.
+template <Backing backing_>
+struct Dynamic : DynamicCircularQueue<int> {
+    Dynamic() : DynamicCircularQueue<int>(::capacity, backing_) {}
+};
+
+using Fixed = CircularQueue<int, capacity>;
+using Rejecting = CircularQueue<int, capacity, Overflow::reject>;
+using Heap = Dynamic<Backing::heap>;
+using Mirrored = Dynamic<Backing::mirrored>;
+using Spsc = SpscCircularQueue<int, capacity>;
+using Mpmc = MpmcCircularQueue<int, capacity>;
+using Async = AsyncCircularQueue<int, capacity>;
+
+template <typename Queue>
+auto pushPop(char const* name) -> void {
+    auto queue = std::make_unique<Queue>();
+    std::printf("%-28s %10.1f\n", name, pushPop(*queue, 20000));
+}
+
+template <typename Queue>
+auto access(char const* name) -> void {
+    auto a = std::make_unique<Queue>(), b = std::make_unique<Queue>(), c = std::make_unique<Queue>();
+    std::printf("%-28s %10.1f %10.1f %10.1f\n", name, randomAccess(*a, 1 << 26), iterate(*b, 50000),
+                iterateSpans(*c, 50000));
+}
+
+template <typename Queue>
+auto latency(char const* name) -> void {
+    auto p = pingPong<Queue>(100000);
+    std::printf("%-28s %10.0f %10.0f %10.0f\n", name, p.p50, p.p99, p.p999);
+}
+
+int main() {
+    std::printf("%-28s %10s\n", "push/pop", "M/s");
+    pushPop<Locked<Fixed>>("CircularQueue + mutex");
+    pushPop<Rejecting>("CircularQueue (reject)");
+    pushPop<Heap>("DynamicCircularQueue heap");
+    pushPop<Mirrored>("DynamicCircularQueue mirror");
+    pushPop<Spsc>("SpscCircularQueue");
+    pushPop<Mpmc>("MpmcCircularQueue");
+    pushPop<Async>("AsyncCircularQueue");
+
+    std::printf("\n%-28s %10s %10s %10s\n", "access (M/s)", "[]", "iterate", "spans");
+    access<Fixed>("CircularQueue");
+    access<Heap>("DynamicCircularQueue heap");
+    access<Mirrored>("DynamicCircularQueue mirror");
+
+    std::printf("\n%-28s %10s %10s %10s\n", "ping-pong round trip (ns)", "p50", "p99", "p999");
+    latency<Locked<Fixed>>("CircularQueue + mutex");
+    latency<Locked<Heap>>("DynamicCircularQueue + mutex");
+    latency<Spsc>("SpscCircularQueue");
+    latency<Mpmc>("MpmcCircularQueue");
+    latency<Async>("AsyncCircularQueue");
+
+    constexpr int messages = 200000;
+    std::printf("\n%8s %16s %16s\n", "threads", "mutex (M/s)", "mpmc (M/s)");
+    for (int threads : {1, 2, 4, 8, 16, 32}) {
+        auto mutex = contention<Locked<Fixed>>(threads, messages / threads);
+        auto mpmc = contention<Mpmc>(threads, messages / threads);
+        std::printf("%8d %16.2f %16.2f\n", threads, mutex, mpmc);
+    }
+}
@@ -1,9 +1,37 @@
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
 #include <ostream>
+#include <span>
+#include <type_traits>
+#include <utility>
 
 #pragma once
 
-template <typename T, size_t capacity_>
-class CircularQueue {
+// What a queue does with a new element when it is already full.
+enum class Overflow {
+    overwrite,  // Pop the oldest element to make room.
+    reject,     // Drop the new element and report failure.
+    block,      // Wait until a consumer makes room; see AsyncCircularQueue.
+};
+
+// Everything CircularQueue and DynamicCircularQueue share. They differ only in where the elements
+// live, so Derived provides:
+//  - data(), the first slot,
+//  - capacity(),
+//  - wrap(pos), which maps a position to its slot,
+//  - contiguous(), true if the storage is mirrored so that capacity() slots from any slot are
+//    contiguous in memory.
+template <typename Derived, typename T, Overflow overflow_>
+class CircularQueueBase {
+    static_assert(overflow_ != Overflow::block,
+                  "CircularQueue is single threaded and cannot wait for room; use AsyncCircularQueue");
+
 public:
     template <typename IteratorType>
     class iterator;
@@ -12,17 +40,17 @@ public:
 
     template <typename IteratorType>
     class iterator {
+        using Queue = std::conditional_t<std::is_const_v<std::remove_pointer_t<IteratorType>>, Derived const, Derived>;
+
     public:
-        friend class CircularQueue;
+        friend class CircularQueueBase;
 
-        auto operator*() -> T& { return *curr; }
-        auto operator*() const -> T& { return *curr; }
+        auto operator*() const -> decltype(auto) { return *operator->(); }
 
-        auto operator->() -> T* { return curr; }
-        auto operator->() const -> T const* { return curr; }
+        auto operator->() const -> IteratorType { return queue->data() + queue->wrap(pos); }
 
         auto operator++() -> iterator& {
-            advance(1);
+            ++pos;
             return *this;
         }
 
@@ -33,7 +61,7 @@ public:
         }
 
         auto operator--() -> iterator& {
-            advance(-1);
+            --pos;
             return *this;
         }
 
@@ -43,127 +71,285 @@ public:
             return temp;
         }
 
-        auto operator+(int offset) const -> iterator {
-            iterator result = *this;
-            result.advance(offset);
-            return result;
-        }
+        auto operator+(int offset) const -> iterator { return {queue, pos + offset}; }
 
-        auto operator-(int offset) const -> iterator {
-            iterator result = *this;
-            result.advance(-offset);
-            return result;
-        }
+        auto operator-(int offset) const -> iterator { return {queue, pos - offset}; }
 
-        auto operator<=>(iterator const& other) const -> std::strong_ordering {
-            size_t diff1 = distance();
-            size_t diff2 = other.distance();
-            if (diff1 < diff2) return std::strong_ordering::less;
-            if (diff1 > diff2) return std::strong_ordering::greater;
-            return std::strong_ordering::equal;
-        }
+        auto operator<=>(iterator const& other) const -> std::strong_ordering { return pos <=> other.pos; }
+
+        auto operator==(iterator const& other) const -> bool { return pos == other.pos; }
 
         friend auto operator<<(std::ostream& os, iterator const& it) -> std::ostream& {
-            os << it.curr;
+            os << it.operator->();
             return os;
         }
 
     private:
-        iterator(IteratorType start, IteratorType head, IteratorType tail, size_t size)
-            : iterator(start, head, tail, tail, size) {}
-        iterator(IteratorType start, IteratorType head, IteratorType tail, IteratorType curr, size_t size)
-            : start(start), head(head), tail(tail), curr(curr), size_(size) {}
-
-        void advance(int offset) {
-            auto temp = curr + offset;
-            T* end = start + realCapacity;
-
-            if (offset > 0) {
-                // Increment wrap-around case.
-                curr = (temp >= end) ? start + (temp - end) : temp;
-            } else {
-                // Decrement wrap-around case.
-                curr = (temp < start) ? end - (start - temp) : temp;
-            }
-        }
+        iterator(Queue* queue, size_t pos) : queue(queue), pos(pos) {}
 
-        size_t distance() const {
-            if (curr >= tail) {
-                return curr - tail;
-            } else {
-                return realCapacity - (tail - start) + (curr - start);
-            }
-        }
-
-        IteratorType start;
-        IteratorType head;
-        IteratorType tail;
-        IteratorType curr;
-        size_t size_;
+        Queue* queue;
+        size_t pos;  // Position in the queue's history; see CircularQueueBase::head.
     };
 
-    CircularQueue() : CircularQueue({}) {}
+    auto operator[](size_t index) -> T& { return data()[wrap(tail + index)]; }
+    auto operator[](size_t index) const -> const T& { return data()[wrap(tail + index)]; }
 
-    CircularQueue(std::initializer_list<T> il) : size_(0), head(data), tail(data) {
-        for (auto const& e : il) push(e);
-    }
+    auto begin() -> iterator_type { return {&derived(), tail}; }
+    auto end() -> iterator_type { return {&derived(), head}; }
 
-    auto operator[](size_t index) -> T& { return *(wrap(tail + index)); }
-    auto operator[](size_t index) const -> const T& { return *(wrap(tail + index)); }
+    auto begin() const -> const const_iterator_type { return {&derived(), tail}; }
+    auto end() const -> const const_iterator_type { return {&derived(), head}; }
 
-    auto begin() -> iterator_type { return {data, head, tail, size_}; }
-    auto end() -> iterator_type { return {data, head, tail, head, size_}; }
+    auto cbegin() const -> const const_iterator_type { return {&derived(), tail}; }
+    auto cend() const -> const const_iterator_type { return {&derived(), head}; }
 
-    auto begin() const -> const const_iterator_type { return {data, head, tail, size_}; }
-    auto end() const -> const const_iterator_type { return {data, head, tail, head, size_}; }
+    auto full() const -> bool { return size() == capacity(); }
+    auto empty() const -> bool { return head == tail; }
+    auto size() const -> size_t { return head - tail; }
 
-    auto cbegin() const -> const const_iterator_type { return {data, head, tail, size_}; }
-    auto cend() const -> const const_iterator_type { return {data, head, tail, head, size_}; }
+    auto front() -> T& { return data()[wrap(tail)]; }
+    auto front() const -> T const& { return data()[wrap(tail)]; }
 
-    auto full() const -> bool { return size_ == capacity_; }
-    auto empty() const -> bool { return size_ == 0; }
-    auto size() const -> size_t { return size_; }
-    auto capacity() const -> size_t { return capacity_; }
+    auto back() -> T& { return data()[wrap(head - 1)]; }
+    auto back() const -> T const& { return data()[wrap(head - 1)]; }
 
-    auto front() -> T& { return *tail; }
-    auto front() const -> T { return *tail; }
+    // Returns false if the queue was full and the policy is Overflow::reject.
+    auto push(T const& item) -> bool {
+        if constexpr (overflow_ == Overflow::reject) {
+            return emplace(item) != nullptr;
+        } else {
+            emplace(item);
+            return true;
+        }
+    }
 
-    auto push(T item) -> bool {
-        if (full()) pop();
-        *head = item;
-        head = wrap(head + 1);
-        if (size_ < capacity_) size_++;
-        return true;
+    auto push(T&& item) -> bool {
+        if constexpr (overflow_ == Overflow::reject) {
+            return emplace(std::move(item)) != nullptr;
+        } else {
+            emplace(std::move(item));
+            return true;
+        }
+    }
+
+    // Constructs a new element in place from args. If the queue is full, the oldest element is
+    // popped first, or with Overflow::reject nothing is constructed and nullptr is returned.
+    template <typename... Args>
+    auto emplace(Args&&... args) -> std::conditional_t<overflow_ == Overflow::reject, T*, T&> {
+        T* slot;
+        if (!full()) {
+            slot = std::construct_at(data() + wrap(head), std::forward<Args>(args)...);
+        } else if constexpr (overflow_ == Overflow::reject) {
+            return nullptr;
+        } else {
+            // args may refer to the oldest element, as in q.push(q.front()), so the new element is
+            // built before that one is popped.
+            T item(std::forward<Args>(args)...);
+            pop();
+            slot = std::construct_at(data() + wrap(head), std::move(item));
+        }
+        ++head;
+        if constexpr (overflow_ == Overflow::reject) {
+            return slot;
+        } else {
+            return *slot;
+        }
     }
 
     auto pop() -> bool {
         if (empty()) return false;
-        tail = wrap(tail + 1);
-        size_--;
+        std::destroy_at(data() + wrap(tail++));
         return true;
     }
 
-    friend std::ostream& operator<<(std::ostream& os, CircularQueue const& cq) {
-        for (std::size_t i = 0; i < cq.size_; ++i) {
-            os << cq[i] << (i < cq.size_ - 1 ? ", " : "");
+    // Pushes every element of [first, last) in order, popping the oldest elements as needed. With
+    // Overflow::reject, only the elements that fit are pushed. Random access ranges are copied in at
+    // most two contiguous blocks.
+    //
+    // Returns the number of elements pushed.
+    template <typename InputIt>
+    auto push_n(InputIt first, InputIt last) -> size_t {
+        if constexpr (std::random_access_iterator<InputIt>) {
+            auto n = static_cast<size_t>(last - first);
+            auto kept = std::min(n, capacity());
+            if constexpr (overflow_ == Overflow::reject) {
+                kept = n = std::min(n, capacity() - size());
+            } else {
+                // Only the newest capacity() elements would survive anyway.
+                first += n - kept;
+                while (capacity() - size() < kept) pop();
+            }
+
+            auto const start = wrap(head);
+            auto const split = contiguousRun(start, kept);
+            std::uninitialized_copy(first, first + split, data() + start);
+            head += split;
+            std::uninitialized_copy(first + split, first + kept, data());
+            head += kept - split;
+            return n;
+        } else {
+            size_t n = 0;
+            for (; first != last && push(*first); ++first) ++n;
+            return n;
+        }
+    }
+
+    // Moves up to out.size() of the oldest elements into out, in order, and pops them.
+    //
+    // Returns the number of elements popped.
+    auto pop_n(std::span<T> out) -> size_t {
+        auto const n = std::min(out.size(), size());
+        auto [first, second] = peek_spans();
+        auto const split = std::min(n, first.size());
+        std::move(first.begin(), first.begin() + split, out.begin());
+        std::move(second.begin(), second.begin() + (n - split), out.begin() + split);
+        std::destroy(first.begin(), first.begin() + split);
+        std::destroy(second.begin(), second.begin() + (n - split));
+        tail += n;
+        return n;
+    }
+
+    // Calls f with each contiguous block of up to limit of the oldest elements, as a std::span<T>,
+    // oldest first, then pops them all at once. f may move the elements out. If f throws, nothing is
+    // popped.
+    //
+    // Returns the number of elements popped.
+    template <typename F>
+    auto consume(F&& f, size_t limit = std::numeric_limits<size_t>::max()) -> size_t {
+        auto const n = std::min(limit, size());
+        auto [first, second] = peek_spans();
+        first = first.first(std::min(n, first.size()));
+        second = second.first(n - first.size());
+        if (!first.empty()) f(first);
+        if (!second.empty()) f(second);
+        std::destroy(first.begin(), first.end());
+        std::destroy(second.begin(), second.end());
+        tail += n;
+        return n;
+    }
+
+    // Returns the elements, oldest first, as at most two contiguous blocks. The second block is
+    // empty unless the elements wrap around the end of the storage, which mirrored storage never
+    // does.
+    auto peek_spans() -> std::pair<std::span<T>, std::span<T>> {
+        auto const start = wrap(tail);
+        auto const split = contiguousRun(start, size());
+        return {{data() + start, split}, {data(), size() - split}};
+    }
+
+    auto peek_spans() const -> std::pair<std::span<T const>, std::span<T const>> {
+        auto const start = wrap(tail);
+        auto const split = contiguousRun(start, size());
+        return {{data() + start, split}, {data(), size() - split}};
+    }
+
+    // Removes the newest element, so the queue can also be used as a bounded double-ended queue.
+    auto pop_back() -> bool {
+        if (empty()) return false;
+        std::destroy_at(data() + wrap(--head));
+        return true;
+    }
+
+    auto clear() -> void {
+        if constexpr (std::is_trivially_destructible_v<T>) {
+            tail = head;
+        } else {
+            while (pop()) {}
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, Derived const& cq) {
+        for (std::size_t i = 0; i < cq.size(); ++i) {
+            os << cq[i] << (i < cq.size() - 1 ? ", " : "");
         }
         return os;
     }
 
+protected:
+    CircularQueueBase() = default;
+
+    // Positions only ever increase, so head - tail is the size and no slot is needed to tell a full
+    // queue apart from an empty one. Non power of two capacities would only map positions
+    // inconsistently once head overflows, after 2^64 pushes.
+    size_t head = 0;  // Position after the newest element.
+    size_t tail = 0;  // Position of the oldest element.
+
 private:
-    auto wrap(T* ptr) -> T* {
-        T* end = data + realCapacity;
-        return ptr >= end ? data + (ptr - end) : ptr;
+    auto derived() -> Derived& { return static_cast<Derived&>(*this); }
+    auto derived() const -> Derived const& { return static_cast<Derived const&>(*this); }
+
+    auto data() -> T* { return derived().data(); }
+    auto data() const -> T const* { return derived().data(); }
+    auto capacity() const -> size_t { return derived().capacity(); }
+    auto wrap(size_t pos) const -> size_t { return derived().wrap(pos); }
+
+    // How many of n slots from slot start are contiguous in memory.
+    auto contiguousRun(size_t start, size_t n) const -> size_t {
+        return derived().contiguous() ? n : std::min(n, capacity() - start);
+    }
+};
+
+template <typename T, size_t capacity_, Overflow overflow_ = Overflow::overwrite>
+class CircularQueue : public CircularQueueBase<CircularQueue<T, capacity_, overflow_>, T, overflow_> {
+    using Base = CircularQueueBase<CircularQueue, T, overflow_>;
+    friend Base;
+
+public:
+    CircularQueue() = default;
+
+    CircularQueue(std::initializer_list<T> il) {
+        for (auto const& e : il) this->push(e);
     }
 
-    auto wrap(T* ptr) const -> const T* {
-        const T* end = data + realCapacity;
-        return ptr >= end ? data + (ptr - end) : ptr;
+    CircularQueue(CircularQueue const& other) {
+        for (auto const& e : other) this->push(e);
     }
 
-    static constexpr size_t realCapacity = capacity_ + 1;  // +1 to store one-after-the-last-element.
-    size_t size_;                                          // Required to handle size 0 and 1 cases.
-    T data[realCapacity];                                  // Data is stored in reverse [tail, head].
-    T* head;                                               // Newest element.
-    T* tail;                                               // Oldest element.
-};
\ No newline at end of file
+    CircularQueue(CircularQueue&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        for (auto& e : other) this->push(std::move(e));
+        other.clear();
+    }
+
+    auto operator=(CircularQueue const& other) -> CircularQueue& {
+        if (this != &other) {
+            this->clear();
+            for (auto const& e : other) this->push(e);
+        }
+        return *this;
+    }
+
+    auto operator=(CircularQueue&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> CircularQueue& {
+        if (this != &other) {
+            this->clear();
+            for (auto& e : other) this->push(std::move(e));
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~CircularQueue() { this->clear(); }
+
+    static constexpr auto capacity() -> size_t { return capacity_; }
+
+private:
+    // Maps a position to its slot in data. For power of two capacities this is a single mask; for
+    // other capacities the compiler turns the modulo by a constant into a multiply and shift.
+    static constexpr auto wrap(size_t pos) -> size_t {
+        if constexpr (isPowerOfTwo) {
+            return pos & (capacity_ - 1);
+        } else {
+            return pos % capacity_;
+        }
+    }
+
+    static constexpr auto contiguous() -> bool { return false; }
+
+    static constexpr bool isPowerOfTwo = capacity_ != 0 && (capacity_ & (capacity_ - 1)) == 0;
+
+    // Slots outside [tail, head) hold no object, so T need not be default constructible and nothing
+    // is constructed until it is pushed.
+    auto data() -> T* { return std::launder(reinterpret_cast<T*>(storage)); }
+    auto data() const -> T const* { return std::launder(reinterpret_cast<T const*>(storage)); }
+
+    alignas(T) std::byte storage[capacity_ * sizeof(T)];
+};
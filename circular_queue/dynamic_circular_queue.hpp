@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "circular_queue.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#pragma once
+
+// Where DynamicCircularQueue stores its elements.
+enum class Backing {
+    heap,               // Obtained from the queue's allocator.
+    mirrored,           // The same pages mapped twice in a row, so every read is contiguous.
+    mirroredHugePages,  // As mirrored, but backed by huge pages.
+};
+
+// CircularQueue with a capacity chosen at runtime, stored on the heap rather than inline. The whole
+// interface, including push_n, pop_n and consume, comes from CircularQueueBase.
+//
+// With a mirrored backing the storage is mapped twice back to back, so the element at slot i is
+// also visible at slot i + capacity(). The readable region is then always one contiguous block,
+// whatever the positions of head and tail. The capacity is rounded up so that the storage fills a
+// whole number of pages. Mirrored backings are only available on Linux, and only for trivially
+// copyable T: every object is reachable through two addresses, which only such objects tolerate.
+template <typename T, typename Allocator = std::allocator<T>>
+class DynamicCircularQueue
+    : public CircularQueueBase<DynamicCircularQueue<T, Allocator>, T, Overflow::overwrite> {
+    using Base = CircularQueueBase<DynamicCircularQueue, T, Overflow::overwrite>;
+    friend Base;
+
+public:
+    explicit DynamicCircularQueue(size_t capacity, Allocator const& allocator = Allocator())
+        : allocator(allocator), capacity_(capacity) {
+        initialiseMask();
+        storage = std::allocator_traits<Allocator>::allocate(this->allocator, capacity_);
+    }
+
+    DynamicCircularQueue(size_t capacity, Backing backing, Allocator const& allocator = Allocator())
+        : allocator(allocator), backing(backing), capacity_(capacity) {
+        initialiseMask();
+        if (backing != Backing::heap && !std::is_trivially_copyable_v<T>) {
+            throw std::invalid_argument("DynamicCircularQueue mirrored backings require a trivially copyable T");
+        }
+        if (backing == Backing::heap) {
+            storage = std::allocator_traits<Allocator>::allocate(this->allocator, capacity_);
+        } else {
+            mapMirrored();
+            initialiseMask();
+        }
+    }
+
+    DynamicCircularQueue(DynamicCircularQueue const& other)
+        : DynamicCircularQueue(other.capacity_, other.backing,
+                               std::allocator_traits<Allocator>::select_on_container_copy_construction(other.allocator)) {
+        for (auto const& e : other) this->push(e);
+    }
+
+    DynamicCircularQueue(DynamicCircularQueue&& other) noexcept
+        : allocator(std::move(other.allocator)),
+          backing(other.backing),
+          storage(std::exchange(other.storage, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)),
+          mask(other.mask) {
+        this->head = std::exchange(other.head, 0);
+        this->tail = std::exchange(other.tail, 0);
+    }
+
+    auto operator=(DynamicCircularQueue other) noexcept -> DynamicCircularQueue& {
+        std::swap(allocator, other.allocator);
+        std::swap(backing, other.backing);
+        std::swap(storage, other.storage);
+        std::swap(capacity_, other.capacity_);
+        std::swap(mask, other.mask);
+        std::swap(this->head, other.head);
+        std::swap(this->tail, other.tail);
+        return *this;
+    }
+
+    ~DynamicCircularQueue() {
+        if (storage == nullptr) return;
+        this->clear();
+        if (backing == Backing::heap) {
+            std::allocator_traits<Allocator>::deallocate(allocator, storage, capacity_);
+        } else {
+            unmapMirrored();
+        }
+    }
+
+    auto capacity() const -> size_t { return capacity_; }
+
+private:
+    auto data() -> T* { return storage; }
+    auto data() const -> T const* { return storage; }
+
+    // Maps a position to its slot in data, with a mask when the capacity is a power of two.
+    auto wrap(size_t pos) const -> size_t { return mask != 0 ? pos & mask : pos % capacity_; }
+
+    auto contiguous() const -> bool { return backing != Backing::heap; }
+
+    auto initialiseMask() -> void {
+        if (capacity_ == 0) {
+            throw std::invalid_argument("DynamicCircularQueue requires a non-zero capacity");
+        }
+        mask = (capacity_ & (capacity_ - 1)) == 0 ? capacity_ - 1 : 0;
+    }
+
+#ifdef __linux__
+    auto mirroredBytes() const -> size_t {
+        auto const page = backing == Backing::mirroredHugePages ? size_t{2} << 20
+                                                                : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const unit = std::lcm(page, sizeof(T));
+        return (capacity_ * sizeof(T) + unit - 1) / unit * unit;
+    }
+
+    auto mapMirrored() -> void {
+        auto const bytes = mirroredBytes();
+        auto const fail = [](int fd) {
+            auto const error = errno;
+            if (fd >= 0) close(fd);
+            throw std::system_error(error, std::system_category(), "DynamicCircularQueue mirrored mapping");
+        };
+
+        auto const fd = memfd_create("DynamicCircularQueue",
+                                     backing == Backing::mirroredHugePages ? MFD_HUGETLB : 0);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) fail(fd);
+
+        // Reserve twice the address space, then map the same file over both halves.
+        auto* region = static_cast<std::byte*>(
+            mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (region == MAP_FAILED) fail(fd);
+        for (auto* half : {region, region + bytes}) {
+            if (mmap(half, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(region, 2 * bytes);
+                fail(fd);
+            }
+        }
+        close(fd);
+
+        storage = reinterpret_cast<T*>(region);
+        capacity_ = bytes / sizeof(T);
+    }
+
+    auto unmapMirrored() -> void { munmap(storage, 2 * mirroredBytes()); }
+#else
+    auto mapMirrored() -> void {
+        throw std::runtime_error("DynamicCircularQueue mirrored backings require Linux");
+    }
+
+    auto unmapMirrored() -> void {}
+#endif
+
+    [[no_unique_address]] Allocator allocator;
+    Backing backing = Backing::heap;
+    T* storage = nullptr;
+    size_t capacity_;
+    size_t mask = 0;  // capacity_ - 1 if capacity_ is a power of two, 0 otherwise.
+};
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <utility>
+
+#pragma once
+
+// Bounded multi-producer/multi-consumer variant of CircularQueue (Dmitry Vyukov's design).
+//
+// Every slot carries a sequence number which tells producers and consumers whose turn it is: a
+// slot at position pos is free for the producer claiming pos when its sequence equals pos, and
+// holds data for the consumer claiming pos when its sequence equals pos + 1. Producers and
+// consumers therefore only contend on their own index, with a single compare-and-swap each.
+//
+// Pushing to a full queue fails (try_push) or waits (push) instead of overwriting.
+template <typename T, size_t capacity_>
+class MpmcCircularQueue {
+    // With a single slot, the sequence pos + 1 that marks it full for the consumer of pos is also
+    // the sequence that marks it free for the producer of pos + 1.
+    static_assert(capacity_ >= 2, "MpmcCircularQueue needs at least two slots");
+
+public:
+    MpmcCircularQueue() {
+        for (size_t i = 0; i < capacity_; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcCircularQueue(MpmcCircularQueue const&) = delete;
+    auto operator=(MpmcCircularQueue const&) -> MpmcCircularQueue& = delete;
+
+    // No other thread may still be using the queue, so every position in [tail, head) holds an
+    // element, unless its producer's constructor threw.
+    ~MpmcCircularQueue() {
+        for (auto pos = tail.load(std::memory_order_relaxed); pos != head.load(std::memory_order_relaxed); ++pos) {
+            auto& slot = slots[pos % capacity_];
+            if (slot.sequence.load(std::memory_order_relaxed) == pos + 1) std::destroy_at(slot.data());
+        }
+    }
+
+    // Returns false if the queue is full.
+    auto try_push(T const& item) -> bool { return try_emplace(item); }
+    auto try_push(T&& item) -> bool { return try_emplace(std::move(item)); }
+
+    template <typename... Args>
+    auto try_emplace(Args&&... args) -> bool {
+        auto pos = head.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos % capacity_];
+            auto const diff = distance(slot->sequence.load(std::memory_order_acquire), pos);
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // The slot still holds data from the previous lap.
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        std::construct_at(slot->data(), std::forward<Args>(args)...);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false if the queue is empty.
+    auto try_pop(T& item) -> bool {
+        auto pos = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[pos % capacity_];
+            auto const diff = distance(slot->sequence.load(std::memory_order_acquire), pos + 1);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // The slot has not been written in this lap yet.
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(*slot->data());
+        std::destroy_at(slot->data());
+        slot->sequence.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    // Claims up to limit of the oldest elements with a single compare-and-swap, calls f with each
+    // contiguous run of them, oldest first, then hands the slots back to the producers. Slots
+    // interleave data with sequence numbers, so each run is passed as a random access range of T&
+    // rather than a std::span. f may move the elements out. Even if f throws, every claimed element
+    // is consumed.
+    //
+    // Returns the number of elements consumed.
+    template <typename F>
+    auto consume(F&& f, size_t limit = std::numeric_limits<size_t>::max()) -> size_t {
+        limit = std::min(limit, capacity_);
+        auto pos = tail.load(std::memory_order_relaxed);
+        size_t n;
+        do {
+            n = 0;
+            while (n < limit && distance(slots[(pos + n) % capacity_].sequence.load(std::memory_order_acquire),
+                                         pos + n + 1) == 0) {
+                ++n;
+            }
+            if (n == 0) return 0;
+        } while (!tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed));
+
+        // The claim above is the only read-modify-write. Each element is then destroyed and its slot
+        // released with a plain store of its sequence number, even if f throws.
+        struct Release {
+            ~Release() {
+                for (size_t i = 0; i < n; ++i) {
+                    auto& slot = queue.slots[(pos + i) % capacity_];
+                    std::destroy_at(slot.data());
+                    slot.sequence.store(pos + i + capacity_, std::memory_order_release);
+                }
+            }
+            MpmcCircularQueue& queue;
+            size_t pos;
+            size_t n;
+        } release{*this, pos, n};
+
+        auto const start = pos % capacity_;
+        auto const split = std::min(n, capacity_ - start);
+        auto const elements = [](std::span<Slot> run) {
+            return run | std::views::transform([](Slot& slot) -> T& { return *slot.data(); });
+        };
+        f(elements(std::span<Slot>(slots + start, split)));
+        if (split < n) f(elements(std::span<Slot>(slots, n - split)));
+        return n;
+    }
+
+    // Waits, with exponential backoff, until there is room for item.
+    auto push(T const& item) -> void {
+        for (Backoff backoff; !try_push(item);) backoff();
+    }
+
+    auto push(T&& item) -> void {
+        for (Backoff backoff; !try_push(std::move(item));) backoff();
+    }
+
+    // Waits, with exponential backoff, until there is an element to pop.
+    auto pop(T& item) -> void {
+        for (Backoff backoff; !try_pop(item);) backoff();
+    }
+
+    // Only exact when no other thread is pushing or popping concurrently.
+    auto empty() const -> bool { return size() == 0; }
+    auto size() const -> size_t {
+        auto const h = head.load(std::memory_order_acquire);
+        auto const t = tail.load(std::memory_order_acquire);
+        return h > t ? h - t : 0;
+    }
+    auto capacity() const -> size_t { return capacity_; }
+
+private:
+    // A slot holds an element only between the store of sequence pos + 1 by its producer and the
+    // store of pos + capacity_ by its consumer, so T need not be default constructible.
+    struct Slot {
+        auto data() -> T* { return std::launder(reinterpret_cast<T*>(storage)); }
+
+        std::atomic<size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    // Spins for exponentially longer between attempts, then yields the thread once spinning is
+    // unlikely to help.
+    class Backoff {
+    public:
+        auto operator()() -> void {
+            if (spins <= maxSpins) {
+                for (size_t i = 0; i < spins; ++i) std::atomic_signal_fence(std::memory_order_seq_cst);
+                spins *= 2;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        static constexpr size_t maxSpins = 64;
+        size_t spins = 1;
+    };
+
+    static auto distance(size_t sequence, size_t pos) -> std::intptr_t {
+        return static_cast<std::intptr_t>(sequence - pos);
+    }
+
+    static constexpr size_t cacheLineSize = 64;
+
+    alignas(cacheLineSize) Slot slots[capacity_];
+    alignas(cacheLineSize) std::atomic<size_t> head = 0;  // Next position to write.
+    alignas(cacheLineSize) std::atomic<size_t> tail = 0;  // Next position to read.
+};
@@ -0,0 +1,124 @@
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+#pragma once
+
+// Lock-free single-producer/single-consumer variant of CircularQueue.
+//
+// Exactly one thread may call push() and exactly one thread may call front() and pop(). Unlike
+// CircularQueue, pushing to a full queue fails instead of overwriting the oldest element, since the
+// producer cannot safely reclaim a slot the consumer may be reading.
+template <typename T, size_t capacity_>
+class SpscCircularQueue {
+public:
+    SpscCircularQueue() = default;
+
+    SpscCircularQueue(SpscCircularQueue const&) = delete;
+    auto operator=(SpscCircularQueue const&) -> SpscCircularQueue& = delete;
+
+    ~SpscCircularQueue() {
+        while (pop()) {}
+    }
+
+    // Producer only. Returns false if the queue is full.
+    auto push(T const& item) -> bool { return emplace(item); }
+    auto push(T&& item) -> bool { return emplace(std::move(item)); }
+
+    template <typename... Args>
+    auto emplace(Args&&... args) -> bool {
+        auto const h = head.load(std::memory_order_relaxed);
+        auto const next = wrap(h + 1);
+        if (next == cachedTail) {
+            // Only reload the consumer's index when the cached copy says the queue is full.
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (next == cachedTail) return false;
+        }
+        std::construct_at(data() + h, std::forward<Args>(args)...);
+        head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns nullptr if the queue is empty.
+    auto front() -> T* {
+        auto const t = tail.load(std::memory_order_relaxed);
+        if (t == cachedHead) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t == cachedHead) return nullptr;
+        }
+        return data() + t;
+    }
+
+    // Consumer only. Moves the oldest element into item. Returns false if the queue is empty.
+    auto pop(T& item) -> bool {
+        auto* f = front();
+        if (f == nullptr) return false;
+        item = std::move(*f);
+        std::destroy_at(f);
+        tail.store(wrap(tail.load(std::memory_order_relaxed) + 1), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Discards the oldest element. Returns false if the queue is empty.
+    auto pop() -> bool {
+        auto* f = front();
+        if (f == nullptr) return false;
+        std::destroy_at(f);
+        tail.store(wrap(tail.load(std::memory_order_relaxed) + 1), std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls f with each contiguous block of up to limit of the oldest elements, as a
+    // std::span<T>, oldest first, then releases them all to the producer with a single store. f may
+    // move the elements out. If f throws, nothing is consumed.
+    //
+    // Returns the number of elements consumed.
+    template <typename F>
+    auto consume(F&& f, size_t limit = std::numeric_limits<size_t>::max()) -> size_t {
+        auto const t = tail.load(std::memory_order_relaxed);
+        cachedHead = head.load(std::memory_order_acquire);
+        auto const available = cachedHead >= t ? cachedHead - t : realCapacity - t + cachedHead;
+        auto const n = std::min(limit, available);
+        if (n == 0) return 0;
+
+        auto const split = std::min(n, realCapacity - t);
+        f(std::span<T>(data() + t, split));
+        if (split < n) f(std::span<T>(data(), n - split));
+        std::destroy_n(data() + t, split);
+        std::destroy_n(data(), n - split);
+        tail.store(t + n >= realCapacity ? t + n - realCapacity : t + n, std::memory_order_release);
+        return n;
+    }
+
+    // Only exact when neither the producer nor the consumer is running concurrently.
+    auto empty() const -> bool { return size() == 0; }
+    auto size() const -> size_t {
+        auto const h = head.load(std::memory_order_acquire);
+        auto const t = tail.load(std::memory_order_acquire);
+        return h >= t ? h - t : realCapacity - t + h;
+    }
+    auto capacity() const -> size_t { return capacity_; }
+
+private:
+    static auto wrap(size_t index) -> size_t { return index == realCapacity ? 0 : index; }
+
+    auto data() -> T* { return std::launder(reinterpret_cast<T*>(storage)); }
+
+    // Separate cache lines stop the producer and consumer from invalidating each other's lines on
+    // every operation (false sharing).
+    static constexpr size_t cacheLineSize = 64;
+    static constexpr size_t realCapacity = capacity_ + 1;  // +1 to tell full apart from empty.
+
+    alignas(cacheLineSize) std::atomic<size_t> head = 0;  // Next slot to write, owned by producer.
+    size_t cachedTail = 0;                                // Producer's last seen value of tail.
+    alignas(cacheLineSize) std::atomic<size_t> tail = 0;  // Next slot to read, owned by consumer.
+    size_t cachedHead = 0;                                // Consumer's last seen value of head.
+    // Raw storage, so that T need not be default constructible: slots hold an element only between
+    // push and pop.
+    alignas(std::max(cacheLineSize, alignof(T))) std::byte storage[realCapacity * sizeof(T)];
+};
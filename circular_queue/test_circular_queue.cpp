@@ -1,9 +1,23 @@
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
 #include <initializer_list>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
+#include "async_circular_queue.hpp"
 #include "circular_queue.hpp"
 #include "doctest.h"
+#include "dynamic_circular_queue.hpp"
+#include "mpmc_circular_queue.hpp"
+#include "spsc_circular_queue.hpp"
+#include "windowed_aggregate.hpp"
 
 TEST_CASE("Initialiser list constructor") {
     CircularQueue<int, 3> cq = {1, 2, 3};
@@ -213,4 +227,650 @@ TEST_CASE("iterator comparison") {
         CHECK(cq.begin() < it);
         CHECK(it < cq.end());
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("power of two capacity") {
+    SUBCASE("wraps around with a mask") {
+        CircularQueue<int, 4> cq = {1, 2, 3, 4};
+        CHECK(cq.full());
+        cq.push(5);
+        cq.push(6);
+        CHECK(cq[0] == 3);
+        CHECK(cq[3] == 6);
+        CHECK(cq.front() == 3);
+        CHECK(*(cq.end() - 1) == 6);
+    }
+
+    SUBCASE("iterating the whole queue") {
+        CircularQueue<int, 4> cq = {1, 2, 3};
+        cq.pop();
+        cq.push(4);
+        cq.push(5);
+        int expected = 2;
+        for (auto it = cq.begin(); it != cq.end(); ++it) {
+            CHECK(*it == expected++);
+        }
+        CHECK(expected == 6);
+    }
+}
+
+TEST_CASE("iterator is a single index") {
+    CHECK(sizeof(CircularQueue<int, 4>::iterator_type) == sizeof(int*) + sizeof(size_t));
+}
+
+TEST_CASE("move-aware and in-place construction") {
+    SUBCASE("emplace constructs in place") {
+        CircularQueue<std::string, 2> cq;
+        CHECK(cq.emplace(3, 'a') == "aaa");
+        cq.emplace("bb");
+        CHECK(cq[0] == "aaa");
+        CHECK(cq[1] == "bb");
+    }
+
+    SUBCASE("push moves move-only types") {
+        CircularQueue<std::unique_ptr<int>, 2> cq;
+        cq.push(std::make_unique<int>(1));
+        cq.push(std::make_unique<int>(2));
+        cq.push(std::make_unique<int>(3));
+        CHECK(*cq[0] == 2);
+        CHECK(*cq[1] == 3);
+        auto moved = std::move(cq);
+        CHECK(cq.empty());
+        CHECK(*moved.front() == 2);
+    }
+
+    SUBCASE("pop and destruction release elements") {
+        auto counter = std::make_shared<int>(0);
+        {
+            CircularQueue<std::shared_ptr<int>, 3> cq = {counter, counter};
+            CHECK(counter.use_count() == 3);
+            cq.pop();
+            CHECK(counter.use_count() == 2);
+            cq.push(counter);
+            cq.push(counter);
+            cq.push(counter);
+            CHECK(counter.use_count() == 4);
+        }
+        CHECK(counter.use_count() == 1);
+    }
+
+    SUBCASE("pushing an element of a full queue") {
+        std::string const oldest(40, 'x');
+        CircularQueue<std::string, 2> cq = {oldest, "b"};
+        cq.push(cq.front());
+        CHECK(cq[0] == "b");
+        CHECK(cq[1] == oldest);
+        cq.emplace(cq.front());
+        CHECK(cq[1] == "b");
+    }
+
+    SUBCASE("copies are independent") {
+        CircularQueue<std::string, 3> cq = {"a", "b"};
+        auto copy = cq;
+        copy.push("c");
+        cq = copy;
+        CHECK(cq.size() == 3);
+        CHECK(cq[2] == "c");
+    }
+}
+
+TEST_CASE("bulk push_n, pop_n and peek_spans") {
+    SUBCASE("push_n wraps around") {
+        CircularQueue<int, 4> cq = {1, 2, 3};
+        cq.pop();
+        std::vector<int> block = {4, 5, 6};
+        CHECK(cq.push_n(block.begin(), block.end()) == 3);
+        CHECK(cq.size() == 4);
+        for (int i = 0; i < 4; ++i) CHECK(cq[i] == i + 3);
+    }
+
+    SUBCASE("push_n keeps only the newest elements") {
+        CircularQueue<std::string, 3> cq = {"a"};
+        std::vector<std::string> block = {"b", "c", "d", "e"};
+        CHECK(cq.push_n(block.begin(), block.end()) == 4);
+        CHECK(cq.size() == 3);
+        CHECK(cq[0] == "c");
+        CHECK(cq[2] == "e");
+    }
+
+    SUBCASE("peek_spans splits at the end of storage") {
+        CircularQueue<int, 4> cq = {1, 2, 3, 4};
+        auto [first, second] = cq.peek_spans();
+        CHECK(first.size() == 4);
+        CHECK(second.empty());
+        cq.push(5);
+        cq.push(6);
+        auto const& ccq = cq;
+        auto [cfirst, csecond] = ccq.peek_spans();
+        CHECK(std::vector<int>(cfirst.begin(), cfirst.end()) == std::vector<int>({3, 4}));
+        CHECK(std::vector<int>(csecond.begin(), csecond.end()) == std::vector<int>({5, 6}));
+    }
+
+    SUBCASE("pop_n moves the oldest elements out") {
+        CircularQueue<std::string, 3> cq = {"a", "b", "c"};
+        cq.push("d");
+        std::vector<std::string> out(2);
+        CHECK(cq.pop_n(out) == 2);
+        CHECK(out == std::vector<std::string>({"b", "c"}));
+        CHECK(cq.size() == 1);
+        CHECK(cq.front() == "d");
+        out.resize(5);
+        CHECK(cq.pop_n(out) == 1);
+        CHECK(out[0] == "d");
+        CHECK(cq.empty());
+    }
+}
+
+// Allocator which counts the elements it currently has allocated.
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(size_t* allocated) : allocated(allocated) {}
+
+    auto allocate(size_t n) -> T* {
+        *allocated += n;
+        return std::allocator<T>().allocate(n);
+    }
+
+    auto deallocate(T* p, size_t n) -> void {
+        *allocated -= n;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    size_t* allocated;
+};
+
+TEST_CASE("DynamicCircularQueue") {
+    SUBCASE("runtime capacity on the heap") {
+        DynamicCircularQueue<std::string> q(3);
+        CHECK(q.capacity() == 3);
+        q.push("a");
+        q.push("b");
+        q.push("c");
+        q.push("d");
+        CHECK(q.full());
+        CHECK(q[0] == "b");
+        CHECK(*(q.end() - 1) == "d");
+        auto copy = q;
+        q.pop();
+        CHECK(q.front() == "c");
+        CHECK(copy.front() == "b");
+        auto [first, second] = q.peek_spans();
+        CHECK(first.size() + second.size() == 2);
+    }
+
+    SUBCASE("shares the bulk interface") {
+        DynamicCircularQueue<std::string> q(3);
+        std::vector<std::string> const block = {"a", "b", "c", "d"};
+        CHECK(q.push_n(block.begin(), block.end()) == 4);
+        CHECK(q[0] == "b");
+        q.push(q.front());
+        CHECK(q[2] == "b");
+
+        std::vector<std::string> out(2);
+        CHECK(q.pop_n(out) == 2);
+        CHECK(out == std::vector<std::string>{"c", "d"});
+        size_t consumed = 0;
+        CHECK(q.consume([&](std::span<std::string> items) { consumed += items.size(); }) == 1);
+        CHECK(consumed == 1);
+        CHECK(q.empty());
+    }
+
+    SUBCASE("zero capacity is rejected") {
+        CHECK_THROWS_AS(DynamicCircularQueue<int>(0), std::invalid_argument);
+    }
+
+    SUBCASE("allocator is used for storage") {
+        size_t allocated = 0;
+        {
+            DynamicCircularQueue<int, CountingAllocator<int>> q(100, CountingAllocator<int>(&allocated));
+            CHECK(allocated == 100);
+            q.push(1);
+            auto copy = q;
+            CHECK(allocated == 200);
+            CHECK(copy.front() == 1);
+        }
+        CHECK(allocated == 0);
+    }
+
+#ifdef __linux__
+    SUBCASE("mirrored backing keeps reads contiguous") {
+        DynamicCircularQueue<int> q(1000, Backing::mirrored);
+        CHECK(q.capacity() >= 1000);
+        for (size_t i = 0; i < q.capacity() + 10; ++i) q.push(static_cast<int>(i));
+        auto [first, second] = q.peek_spans();
+        CHECK(first.size() == q.capacity());
+        CHECK(second.empty());
+        bool ordered = true;
+        for (size_t i = 0; i < first.size(); ++i) ordered &= first[i] == static_cast<int>(i + 10);
+        CHECK(ordered);
+    }
+
+    SUBCASE("mirrored backing rejects non trivially copyable types") {
+        CHECK_THROWS_AS(DynamicCircularQueue<std::string>(16, Backing::mirrored), std::invalid_argument);
+    }
+#endif
+}
+
+TEST_CASE("back() and pop_back()") {
+    CircularQueue<int, 3> cq = {1, 2, 3};
+    cq.push(4);
+    CHECK(cq.back() == 4);
+    CHECK(cq.pop_back());
+    CHECK(cq.back() == 3);
+    CHECK(cq.size() == 2);
+    cq.push(5);
+    CHECK(cq[0] == 2);
+    CHECK(cq[2] == 5);
+    cq.clear();
+    CHECK(cq.pop_back() == false);
+}
+
+TEST_CASE("WindowedAggregate") {
+    SUBCASE("aggregates over a sliding window") {
+        WindowedAggregate<int, 3> w;
+        w.push(5);
+        CHECK(w.min() == 5);
+        CHECK(w.max() == 5);
+        w.push(1);
+        w.push(4);
+        CHECK(w.min() == 1);
+        CHECK(w.max() == 5);
+        CHECK(w.sum() == 10);
+        w.push(3);
+        CHECK(w.min() == 1);
+        CHECK(w.max() == 4);
+        CHECK(w.sum() == 8);
+        w.push(7);
+        CHECK(w.min() == 3);
+        CHECK(w.max() == 7);
+        CHECK(w.sum() == 14);
+        w.push(2);
+        CHECK(w.min() == 2);
+        CHECK(w.max() == 7);
+        CHECK(w.mean() == 4);
+    }
+
+    SUBCASE("matches a rescan of the window") {
+        WindowedAggregate<double, 8> w;
+        bool matches = true;
+        unsigned seed = 1;
+        for (int i = 0; i < 1000; ++i) {
+            seed = seed * 1103515245 + 12345;
+            w.push(static_cast<double>(seed % 100));
+            double lo = w.values()[0], hi = w.values()[0];
+            for (auto v : w.values()) {
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+            }
+            matches &= lo == w.min() && hi == w.max();
+        }
+        CHECK(matches);
+        CHECK(w.size() == 8);
+    }
+}
+
+TEST_CASE("consume") {
+    CircularQueue<std::string, 4> cq = {"a", "b", "c", "d"};
+    cq.pop();
+    cq.pop();
+    cq.push("e");
+    cq.push("f");
+
+    std::vector<size_t> segments;
+    std::string consumed;
+    auto const collect = [&](auto segment) {
+        segments.push_back(segment.size());
+        for (auto& e : segment) consumed += std::move(e);
+    };
+    CHECK(cq.consume(collect, 3) == 3);
+    CHECK(segments == std::vector<size_t>{2, 1});
+    CHECK(consumed == "cde");
+    CHECK(cq.front() == "f");
+
+    CHECK(cq.consume(collect) == 1);
+    CHECK(cq.consume(collect) == 0);
+    CHECK(consumed == "cdef");
+    CHECK(segments.size() == 3);
+    CHECK(cq.empty());
+}
+
+TEST_CASE("Overflow::reject") {
+    CircularQueue<int, 3, Overflow::reject> cq = {1, 2, 3, 4};
+    CHECK(cq.size() == 3);
+    CHECK(cq.push(5) == false);
+    CHECK(cq.emplace(5) == nullptr);
+    CHECK(cq[2] == 3);
+
+    cq.pop();
+    CHECK(*cq.emplace(6) == 6);
+    CHECK(cq.front() == 2);
+
+    cq.pop();
+    cq.pop();
+    std::vector<int> in = {7, 8, 9};
+    CHECK(cq.push_n(in.begin(), in.end()) == 2);
+    CHECK(cq[0] == 6);
+    CHECK(cq[2] == 8);
+}
+
+// Eagerly started coroutine that nobody awaits.
+struct Detached {
+    struct promise_type {
+        auto get_return_object() -> Detached { return {}; }
+        auto initial_suspend() -> std::suspend_never { return {}; }
+        auto final_suspend() noexcept -> std::suspend_never { return {}; }
+        auto return_void() -> void {}
+        auto unhandled_exception() -> void { std::terminate(); }
+    };
+};
+
+TEST_CASE("AsyncCircularQueue") {
+    SUBCASE("block suspends producers and consumers") {
+        AsyncCircularQueue<int, 2> queue;
+        std::vector<int> received;
+        int produced = 0;
+
+        [](auto& queue, int& produced) -> Detached {
+            for (int i = 1; i <= 10; ++i) {
+                CHECK(co_await queue.push(i));
+                produced = i;
+            }
+            queue.close();
+        }(queue, produced);
+        // The producer is suspended pushing its third item.
+        CHECK(produced == 2);
+        CHECK(queue.size() == 2);
+
+        [](auto& queue, std::vector<int>& received) -> Detached {
+            while (auto item = co_await queue.pop()) received.push_back(*item);
+        }(queue, received);
+        CHECK(produced == 10);
+        CHECK(received == std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+        CHECK(queue.empty());
+    }
+
+    SUBCASE("push hands items to a waiting pop") {
+        AsyncCircularQueue<std::string, 2> queue;
+        std::optional<std::string> received;
+        [](auto& queue, std::optional<std::string>& received) -> Detached {
+            received = co_await queue.pop();
+        }(queue, received);
+        CHECK(!received);
+
+        CHECK(queue.try_push("handed over"));
+        CHECK(received == "handed over");
+        CHECK(queue.empty());
+    }
+
+    SUBCASE("close fails suspended pushes") {
+        AsyncCircularQueue<int, 1> queue;
+        CHECK(queue.try_push(1));
+        CHECK(queue.try_push(2) == false);
+        std::optional<bool> accepted;
+        [](auto& queue, std::optional<bool>& accepted) -> Detached {
+            accepted = co_await queue.push(2);
+        }(queue, accepted);
+        CHECK(!accepted);
+
+        queue.close();
+        CHECK(accepted == false);
+        CHECK(queue.try_pop() == 1);
+        CHECK(queue.try_pop() == std::nullopt);
+    }
+
+    SUBCASE("reject and overwrite never suspend") {
+        AsyncCircularQueue<int, 2, Overflow::reject> rejecting;
+        AsyncCircularQueue<int, 2, Overflow::overwrite> overwriting;
+        std::vector<bool> results;
+        [](auto& rejecting, auto& overwriting, std::vector<bool>& results) -> Detached {
+            for (int i = 1; i <= 3; ++i) {
+                results.push_back(co_await rejecting.push(i));
+                results.push_back(co_await overwriting.push(i));
+            }
+        }(rejecting, overwriting, results);
+        CHECK(results == std::vector<bool>{true, true, true, true, false, true});
+        CHECK(rejecting.try_pop() == 1);
+        CHECK(overwriting.try_pop() == 2);
+    }
+
+    SUBCASE("threads") {
+        AsyncCircularQueue<int, 4> queue;
+        long sum = 0;
+        std::thread consumer([&] {
+            [](auto& queue, long& sum) -> Detached {
+                while (auto item = co_await queue.pop()) sum += *item;
+            }(queue, sum);
+        });
+        for (int i = 1; i <= 10000; ++i) {
+            while (!queue.try_push(i)) std::this_thread::yield();
+        }
+        queue.close();
+        consumer.join();
+        // The consumer coroutine may finish on either thread, but always before close() returns.
+        CHECK(sum == 10000L * 10001 / 2);
+    }
+}
+
+TEST_CASE("SpscCircularQueue") {
+    SUBCASE("push and pop in order") {
+        SpscCircularQueue<int, 3> q;
+        CHECK(q.empty());
+        CHECK(q.push(1));
+        CHECK(q.push(2));
+        CHECK(q.push(3));
+        CHECK(q.push(4) == false);
+        CHECK(q.size() == 3);
+        CHECK(*q.front() == 1);
+        int item = 0;
+        CHECK(q.pop(item));
+        CHECK(item == 1);
+        CHECK(q.push(4));
+        CHECK(q.pop(item));
+        CHECK(item == 2);
+        CHECK(q.pop(item));
+        CHECK(item == 3);
+        CHECK(q.pop(item));
+        CHECK(item == 4);
+        CHECK(q.pop(item) == false);
+        CHECK(q.front() == nullptr);
+    }
+
+    SUBCASE("elements live only between push and pop") {
+        int value = 7;
+        SpscCircularQueue<std::reference_wrapper<int>, 2> refs;  // Not default constructible.
+        CHECK(refs.push(value));
+        CHECK(&refs.front()->get() == &value);
+
+        auto counter = std::make_shared<int>(0);
+        {
+            SpscCircularQueue<std::shared_ptr<int>, 3> q;
+            q.push(counter);
+            q.push(counter);
+            q.push(counter);
+            CHECK(counter.use_count() == 4);
+            q.pop();
+            std::shared_ptr<int> item;
+            q.pop(item);
+            CHECK(counter.use_count() == 3);
+            item.reset();
+            q.push(counter);
+            CHECK(q.consume([](std::span<std::shared_ptr<int>>) {}, 1) == 1);
+            CHECK(counter.use_count() == 2);
+        }
+        CHECK(counter.use_count() == 1);
+    }
+
+    SUBCASE("handoff between threads") {
+        constexpr int count = 100000;
+        SpscCircularQueue<int, 64> q;
+        std::thread producer([&q] {
+            for (int i = 0; i < count; ++i) {
+                while (!q.push(i)) std::this_thread::yield();
+            }
+        });
+        bool ordered = true;
+        for (int expected = 0; expected < count;) {
+            int item;
+            if (q.pop(item)) {
+                ordered &= item == expected++;
+            }
+        }
+        producer.join();
+        CHECK(ordered);
+        CHECK(q.empty());
+    }
+}
+
+TEST_CASE("MpmcCircularQueue") {
+    SUBCASE("try_push and try_pop in order") {
+        MpmcCircularQueue<int, 3> q;
+        CHECK(q.empty());
+        CHECK(q.try_push(1));
+        CHECK(q.try_push(2));
+        CHECK(q.try_push(3));
+        CHECK(q.try_push(4) == false);
+        CHECK(q.size() == 3);
+        int item = 0;
+        CHECK(q.try_pop(item));
+        CHECK(item == 1);
+        CHECK(q.try_push(4));
+        for (int expected : {2, 3, 4}) {
+            CHECK(q.try_pop(item));
+            CHECK(item == expected);
+        }
+        CHECK(q.try_pop(item) == false);
+    }
+
+    SUBCASE("elements live only between push and pop") {
+        int value = 7;
+        MpmcCircularQueue<std::reference_wrapper<int>, 2> refs;  // Not default constructible.
+        CHECK(refs.try_emplace(value));
+        std::reference_wrapper<int> ref = value;
+        CHECK(refs.try_pop(ref));
+
+        auto counter = std::make_shared<int>(0);
+        {
+            MpmcCircularQueue<std::shared_ptr<int>, 4> q;
+            for (int i = 0; i < 4; ++i) q.push(counter);
+            CHECK(counter.use_count() == 5);
+            std::shared_ptr<int> item;
+            q.pop(item);
+            item.reset();
+            CHECK(counter.use_count() == 4);
+            CHECK(q.consume([](auto&&) {}, 1) == 1);
+            CHECK(counter.use_count() == 3);
+        }
+        CHECK(counter.use_count() == 1);
+    }
+
+    SUBCASE("many producers and consumers") {
+        constexpr int producers = 4;
+        constexpr int consumers = 4;
+        constexpr int count = 20000;
+        MpmcCircularQueue<int, 16> q;
+        std::vector<long long> sums(consumers, 0);
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&q] {
+                for (int i = 1; i <= count; ++i) q.push(i);
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            threads.emplace_back([&q, &sums, c] {
+                for (int i = 0; i < count * producers / consumers; ++i) {
+                    int item;
+                    q.pop(item);
+                    sums[c] += item;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        long long total = 0;
+        for (auto s : sums) total += s;
+        CHECK(total == static_cast<long long>(producers) * count * (count + 1) / 2);
+        CHECK(q.empty());
+    }
+}
+
+TEST_CASE("concurrent consume") {
+    SUBCASE("SpscCircularQueue") {
+        SpscCircularQueue<int, 5> queue;
+        for (int i = 1; i <= 4; ++i) queue.push(i);
+        int popped;
+        queue.pop(popped);
+        queue.pop(popped);
+        for (int i = 5; i <= 7; ++i) queue.push(i);
+
+        std::vector<int> consumed;
+        std::vector<size_t> segments;
+        auto const collect = [&](std::span<int> segment) {
+            segments.push_back(segment.size());
+            consumed.insert(consumed.end(), segment.begin(), segment.end());
+        };
+        CHECK(queue.consume(collect) == 5);
+        CHECK(consumed == std::vector<int>{3, 4, 5, 6, 7});
+        CHECK(segments == std::vector<size_t>{4, 1});
+        CHECK(queue.consume(collect) == 0);
+        CHECK(queue.push(8));
+        CHECK(queue.consume(collect, 1) == 1);
+        CHECK(consumed.back() == 8);
+    }
+
+    SUBCASE("MpmcCircularQueue") {
+        MpmcCircularQueue<int, 4> queue;
+        for (int i = 1; i <= 3; ++i) queue.push(i);
+        int popped;
+        queue.pop(popped);
+        queue.pop(popped);
+        for (int i = 4; i <= 6; ++i) queue.push(i);
+
+        std::vector<int> consumed;
+        auto const collect = [&](auto segment) { consumed.insert(consumed.end(), segment.begin(), segment.end()); };
+        CHECK(queue.consume(collect, 2) == 2);
+        CHECK(queue.consume(collect) == 2);
+        CHECK(consumed == std::vector<int>{3, 4, 5, 6});
+        CHECK(queue.empty());
+        CHECK(queue.try_push(7));
+    }
+
+    SUBCASE("threads") {
+        constexpr int perProducer = 20000;
+        MpmcCircularQueue<int, 64> mpmc;
+        SpscCircularQueue<int, 64> spsc;
+        std::atomic<long> mpmcSum = 0;
+        long spscSum = 0;
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < 2; ++p) {
+            threads.emplace_back([&] {
+                for (int i = 1; i <= perProducer; ++i) mpmc.push(i);
+            });
+        }
+        std::atomic<int> mpmcConsumed = 0;
+        for (int c = 0; c < 2; ++c) {
+            threads.emplace_back([&] {
+                while (mpmcConsumed < 2 * perProducer) {
+                    mpmcConsumed += static_cast<int>(mpmc.consume([&](auto segment) {
+                        for (int e : segment) mpmcSum += e;
+                    }));
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            for (int i = 1; i <= perProducer; ++i) {
+                while (!spsc.push(i)) std::this_thread::yield();
+            }
+        });
+        for (int consumed = 0; consumed < perProducer;) {
+            consumed += static_cast<int>(spsc.consume([&](std::span<int> segment) {
+                for (int e : segment) spscSum += e;
+            }));
+        }
+        for (auto& t : threads) t.join();
+
+        CHECK(mpmcSum == 2L * perProducer * (perProducer + 1) / 2);
+        CHECK(spscSum == 1L * perProducer * (perProducer + 1) / 2);
+    }
+}
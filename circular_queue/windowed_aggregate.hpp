@@ -0,0 +1,65 @@
+#include <cstddef>
+#include <utility>
+
+#include "circular_queue.hpp"
+
+#pragma once
+
+// Minimum, maximum, sum and mean of the last capacity_ values pushed, each maintained in amortised
+// O(1) per push instead of rescanning the window.
+//
+// The minimum and maximum use monotonic queues: candidates are kept in push order with strictly
+// increasing (for the minimum) or decreasing (for the maximum) values. A new value evicts every
+// candidate from the back that it makes irrelevant, and candidates that slide out of the window
+// are popped from the front, so the front is always the answer and each value enters and leaves
+// each queue at most once.
+template <typename T, size_t capacity_>
+class WindowedAggregate {
+public:
+    auto push(T const& value) -> void {
+        auto const pos = count++;
+        if (window.full()) sum_ -= window.front();
+        window.push(value);
+        sum_ += value;
+
+        update(minima, pos, value, [](T const& candidate, T const& v) { return !(candidate < v); });
+        update(maxima, pos, value, [](T const& candidate, T const& v) { return !(v < candidate); });
+    }
+
+    auto clear() -> void {
+        window.clear();
+        minima.clear();
+        maxima.clear();
+        sum_ = T();
+    }
+
+    // min(), max() and mean() require a non-empty window.
+    auto min() const -> T const& { return minima.front().second; }
+    auto max() const -> T const& { return maxima.front().second; }
+    auto sum() const -> T const& { return sum_; }
+    auto mean() const -> T { return sum_ / static_cast<T>(window.size()); }
+
+    auto empty() const -> bool { return window.empty(); }
+    auto size() const -> size_t { return window.size(); }
+    auto capacity() const -> size_t { return capacity_; }
+
+    // The values currently in the window, oldest first.
+    auto values() const -> CircularQueue<T, capacity_> const& { return window; }
+
+private:
+    using Candidates = CircularQueue<std::pair<size_t, T>, capacity_>;
+
+    // Pops candidates that have left the window or are dominated by value, then appends value.
+    template <typename Dominated>
+    auto update(Candidates& candidates, size_t pos, T const& value, Dominated dominated) -> void {
+        while (!candidates.empty() && candidates.front().first + capacity_ <= pos) candidates.pop();
+        while (!candidates.empty() && dominated(candidates.back().second, value)) candidates.pop_back();
+        candidates.emplace(pos, value);
+    }
+
+    CircularQueue<T, capacity_> window;
+    Candidates minima;
+    Candidates maxima;
+    T sum_ = T();
+    size_t count = 0;  // Number of values ever pushed, which is the position of the next one.
+};
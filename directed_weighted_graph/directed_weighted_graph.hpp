@@ -6,10 +6,16 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <ranges>
 #include <set>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "graph_stats.hpp"
 #include "transform_if.hpp"
 
 namespace xtd {
@@ -29,6 +35,9 @@ class directed_weighted_graph {
     using iterator_type = iterator<typename graph_type::iterator, typename edges_type::iterator>;
     using const_iterator_type =
         iterator<typename graph_type::const_iterator, typename edges_type::const_iterator>;
+    struct snapshot_type;
+    class batch_type;
+    using version_type = std::shared_ptr<snapshot_type const>;
 
     struct value_type {
         N from;
@@ -68,13 +77,15 @@ class directed_weighted_graph {
         using is_transparent = void;
         constexpr auto operator()(edge_type const& lhs, edge_type const& rhs) const noexcept
             -> bool {
-            if (lhs.first.expired() || rhs.first.expired()) {
+            auto const lhs_node = lhs.first.lock();
+            auto const rhs_node = rhs.first.lock();
+            XTD_GRAPH_STATS_ADD(weak_ptr_locks, 2);
+            if (lhs_node == nullptr || rhs_node == nullptr) {
                 return false;
             }
 
             // Compares nodes then compares edges if nodes are the same.
-            return *lhs.first.lock() != *rhs.first.lock() ? *lhs.first.lock() < *rhs.first.lock()
-                                                          : lhs.second < rhs.second;
+            return *lhs_node != *rhs_node ? *lhs_node < *rhs_node : lhs.second < rhs.second;
         }
     };
 
@@ -97,18 +108,22 @@ class directed_weighted_graph {
         iterator() = default;
 
         auto operator*() noexcept -> value_type {
+            XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
             return {*outer_->first, *inner_->first.lock(), inner_->second};
         }
 
         auto operator*() const noexcept -> value_type {
+            XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
             return {*outer_->first, *inner_->first.lock(), inner_->second};
         }
 
         auto operator->() noexcept -> std::shared_ptr<value_type> {
+            XTD_GRAPH_STATS_ADD(allocations, 1);
             return std::make_shared<value_type>(operator*());
         }
 
         auto operator->() const noexcept -> std::shared_ptr<value_type> {
+            XTD_GRAPH_STATS_ADD(allocations, 1);
             return std::make_shared<value_type>(operator*());
         }
 
@@ -188,6 +203,148 @@ class directed_weighted_graph {
         InnerIteratorType inner_;
     };
 
+    // Immutable, compact (compressed sparse row) copy of the graph.
+    //
+    // Nodes are stored in ascending order and referred to by their index. The outgoing edges of
+    // nodes[i] occupy [offsets[i], offsets[i + 1]) of targets and weights, in the same order that
+    // the graph iterates them, i.e. sorted by destination then weight.
+    struct snapshot_type {
+        using size_type = directed_weighted_graph::size_type;
+        using value_type = directed_weighted_graph::value_type;
+        using node_value_type = N;
+        using weight_type = E;
+
+        std::vector<N> nodes;
+        std::vector<size_type> offsets;
+        std::vector<size_type> targets;
+        std::vector<E> weights;
+
+        [[nodiscard]] auto size() const noexcept -> size_type { return nodes.size(); }
+
+        [[nodiscard]] auto edge_count() const noexcept -> size_type { return targets.size(); }
+
+        [[nodiscard]] auto degree(size_type i) const noexcept -> size_type {
+            return offsets[i + 1] - offsets[i];
+        }
+
+        // Returns the index of the node equivalent to value, or size() if no such node exists.
+        //
+        // Complexity is O(log (n)), where n is the number of stored nodes.
+        [[nodiscard]] auto index(N const& value) const -> size_type {
+            auto it = std::lower_bound(nodes.begin(), nodes.end(), value);
+            return it != nodes.end() && !(value < *it) ? it - nodes.begin() : nodes.size();
+        }
+
+        // Returns the graph interpreted as undirected: every edge u → v is also stored as v → u,
+        // self-loops are removed and parallel edges between two nodes are collapsed into the one
+        // with the least weight.
+        //
+        // Complexity is O(e log (e)), where e is the number of stored edges.
+        [[nodiscard]] auto undirected() const -> snapshot_type {
+            auto edges = std::vector<std::tuple<size_type, size_type, E>>();
+            edges.reserve(2 * edge_count());
+            for (size_type u = 0; u < size(); ++u) {
+                for (auto e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    if (targets[e] != u) {
+                        edges.emplace_back(u, targets[e], weights[e]);
+                        edges.emplace_back(targets[e], u, weights[e]);
+                    }
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            auto last = std::unique(edges.begin(), edges.end(), [](auto const& l, auto const& r) {
+                return std::get<0>(l) == std::get<0>(r) && std::get<1>(l) == std::get<1>(r);
+            });
+            edges.erase(last, edges.end());
+
+            auto result = snapshot_type{nodes, std::vector<size_type>(size() + 1, 0), {}, {}};
+            result.targets.reserve(edges.size());
+            result.weights.reserve(edges.size());
+            for (auto const& [u, v, w] : edges) {
+                ++result.offsets[u + 1];
+                result.targets.push_back(v);
+                result.weights.push_back(w);
+            }
+            std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+            return result;
+        }
+    };
+
+    // Stages node and edge insertions and erasures, then applies all of them on commit().
+    //
+    // A batch refers to the graph that created it by address. It must be committed or discarded
+    // before that graph is moved from or destroyed, or commit() would apply it to the wrong graph
+    // or to freed memory.
+    //
+    // Staged edges are sorted once and merged into the edge set of each affected source node in a
+    // single pass, rather than paying a lookup per call. Staged node insertions are applied first,
+    // then edge insertions and erasures (the last one staged for an edge wins), then node
+    // erasures.
+    class batch_type {
+       public:
+        friend class directed_weighted_graph;
+
+        auto insert_node(N const& value) -> batch_type& {
+            inserted_nodes_.push_back(value);
+            return *this;
+        }
+
+        auto erase_node(N const& value) -> batch_type& {
+            erased_nodes_.push_back(value);
+            return *this;
+        }
+
+        auto insert_edge(N const& src, N const& dst, E const& weight) -> batch_type& {
+            edges_.push_back({src, dst, weight, true});
+            return *this;
+        }
+
+        auto erase_edge(N const& src, N const& dst, E const& weight) -> batch_type& {
+            edges_.push_back({src, dst, weight, false});
+            return *this;
+        }
+
+        // Returns the number of staged operations.
+        [[nodiscard]] auto size() const noexcept -> std::size_t {
+            return inserted_nodes_.size() + erased_nodes_.size() + edges_.size();
+        }
+
+        // Applies every staged operation to the graph. The new version is published lazily, by the
+        // next call to snapshot(), so a run of commits with no snapshot between them only pays for
+        // its merges. Versions returned by earlier calls to snapshot() are unaffected and stay
+        // readable.
+        //
+        // All iterators are invalidated.
+        //
+        // Complexity is O(b log (b) + sum of e), where b is the number of staged operations and e
+        // is the number of outgoing edges of each affected source node. Staged node erasures add a
+        // single O(n + e) pass over the whole graph, to remove the edges into them.
+        //
+        // Throws std::runtime_error, without modifying the graph, if a staged edge refers to a
+        // node that neither exists nor is staged for insertion.
+        auto commit() -> void {
+            graph_->apply(*this);
+            inserted_nodes_.clear();
+            erased_nodes_.clear();
+            edges_.clear();
+        }
+
+       private:
+        struct staged_edge {
+            N src;
+            N dst;
+            E weight;
+            bool insert;
+        };
+
+        explicit batch_type(directed_weighted_graph& graph) noexcept : graph_(&graph) {}
+
+        directed_weighted_graph* graph_;
+        std::vector<N> inserted_nodes_;
+        std::vector<N> erased_nodes_;
+        std::vector<staged_edge> edges_;
+    };
+
     directed_weighted_graph() = default;
 
     directed_weighted_graph(std::initializer_list<N> il) noexcept
@@ -200,17 +357,19 @@ class directed_weighted_graph {
 
     directed_weighted_graph(directed_weighted_graph&& other) noexcept {
         std::swap(internal_, other.internal_);
+        std::swap(version_, other.version_);
         other.clear();
     }
 
     auto operator=(directed_weighted_graph&& other) noexcept -> directed_weighted_graph& {
         std::swap(internal_, other.internal_);
+        std::swap(version_, other.version_);
         other.clear();
         return *this;
     }
 
     directed_weighted_graph(directed_weighted_graph const& other) noexcept
-        : internal_(other.internal_) {}
+        : internal_(other.internal_), version_(other.version_) {}
 
     auto operator=(directed_weighted_graph const& other) noexcept -> directed_weighted_graph& {
         return directed_weighted_graph(other).swap(*this);
@@ -225,6 +384,8 @@ class directed_weighted_graph {
     auto insert_node(N const& value) noexcept -> bool {
         if (is_node(value) == false) {
             internal_[std::make_shared<N>(value)];
+            XTD_GRAPH_STATS_ADD(allocations, 1);
+            version_.reset();
             return true;
         }
         return false;
@@ -253,6 +414,7 @@ class directed_weighted_graph {
 
             // Insert pointers into the set mapped to src_ptr.
             internal_[src_ptr].insert({dst_ptr, weight});
+            version_.reset();
             return true;
         }
         return false;
@@ -295,6 +457,7 @@ class directed_weighted_graph {
         }
         auto const& old_iter = find_node(old_data);
         auto new_iter = find_node(new_data);
+        version_.reset();
 
         // Merge incoming edges of old and new into the new node.
         for (auto& [k, v] : internal_) {
@@ -339,6 +502,8 @@ class directed_weighted_graph {
         // Check all nodes and remove the value if there exists an edge.
         for (auto& [k, v] : internal_) {
             auto it = std::find_if(v.begin(), v.end(), [&value](auto const& pair) {
+                XTD_GRAPH_STATS_ADD(edges_scanned, 1);
+                XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
                 return *pair.first.lock() == value;
             });
             if (it != v.end()) {
@@ -347,6 +512,7 @@ class directed_weighted_graph {
         }
         // Remove key last.
         internal_.erase(find_node(value));
+        version_.reset();
         return true;
     }
 
@@ -373,6 +539,7 @@ class directed_weighted_graph {
         }
 
         iter.outer_->second.erase(iter.inner_);  // O(1).
+        version_.reset();
         return true;
     }
 
@@ -385,6 +552,7 @@ class directed_weighted_graph {
     //
     // All iterators are invalidated.
     auto erase_edge(iterator_type i) noexcept -> iterator_type {
+        version_.reset();
         return i.outer_ == i.end_
                    ? end()
                    : iterator(i.begin_, i.end_, i.outer_, i.outer_->second.erase(i.inner_));
@@ -406,7 +574,10 @@ class directed_weighted_graph {
 
     [[nodiscard]] auto size() const noexcept -> size_type { return internal_.size(); }
 
-    auto clear() noexcept -> void { internal_.clear(); }
+    auto clear() noexcept -> void {
+        internal_.clear();
+        version_.reset();
+    }
 
     // Returns true if a node equivalent to value exists in the directed_weighted_graph, and false
     // otherwise.
@@ -414,6 +585,8 @@ class directed_weighted_graph {
     // Complexity is O(log (n)) time.
     [[nodiscard]] auto is_node(N const& value) const -> bool {
         // Make value a pointer so it can be used in node_comparator.
+        XTD_GRAPH_STATS_ADD(node_lookups, 1);
+        XTD_GRAPH_STATS_ADD(allocations, 1);
         return internal_.contains(std::make_shared<N>(value));
     }
 
@@ -431,7 +604,11 @@ class directed_weighted_graph {
         }
         auto const& src_iter = find_node(src);
         return std::any_of(src_iter->second.begin(), src_iter->second.end(),
-                           [&dst](auto const& i) { return *(i.first.lock()) == dst; });
+                           [&dst](auto const& i) {
+                               XTD_GRAPH_STATS_ADD(edges_scanned, 1);
+                               XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
+                               return *(i.first.lock()) == dst;
+                           });
     }
 
     // Returns a sequence of all stored nodes, sorted in ascending order.
@@ -462,7 +639,11 @@ class directed_weighted_graph {
         auto vec = std::vector<E>(edges.size());
         xtd::transform_if(
             edges.begin(), edges.end(), vec.begin(),
-            [&dst](auto const& pair) { return *pair.first.lock() == dst; },
+            [&dst](auto const& pair) {
+                XTD_GRAPH_STATS_ADD(edges_scanned, 1);
+                XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
+                return *pair.first.lock() == dst;
+            },
             [](auto const& pair) { return pair.second; });  // O(e).
         vec.shrink_to_fit();
         return vec;
@@ -480,6 +661,7 @@ class directed_weighted_graph {
         }
 
         auto const& edges = internal_[src_iter->first];
+        XTD_GRAPH_STATS_ADD(allocations, 1);
         auto const& edge_iter = edges.find({std::make_shared<N>(dst), weight});
         if (edge_iter == edges.end()) {
             return end();
@@ -505,11 +687,34 @@ class directed_weighted_graph {
         auto const& edges = find_node(src)->second;  // O(log(n)).
         auto vec = std::vector<N>(edges.size());
         std::transform(edges.begin(), edges.end(), vec.begin(),
-                       [](auto const& pair) { return *pair.first.lock(); });  // O(e).
+                       [](auto const& pair) {
+                           XTD_GRAPH_STATS_ADD(edges_scanned, 1);
+                           XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
+                           return *pair.first.lock();
+                       });  // O(e).
         vec.shrink_to_fit();
         return vec;
     }
 
+    // Returns a transaction object which stages mutations until batch_type::commit() is called.
+    [[nodiscard]] auto batch() noexcept -> batch_type { return batch_type(*this); }
+
+    // Returns an immutable, compact copy of the current state of the graph. The copy is built by
+    // the first call after the graph is mutated or a batch is committed, and shared by every later
+    // call until the graph next changes. A version remains valid for as long as it is held,
+    // regardless of later mutations to the graph.
+    //
+    // Complexity is O(1) if the graph has not changed since the last call, and O(n + e) otherwise,
+    // where n is the number of stored nodes and e is the number of stored edges.
+    //
+    // This caches the version it builds, so it must not run concurrently with another call to
+    // snapshot(), nor with a mutation or a commit() of the same graph. To read the graph from other
+    // threads, hand them the returned version, which is immutable and safe to share.
+    [[nodiscard]] auto snapshot() const -> version_type {
+        if (version_ == nullptr) version_ = make_snapshot();
+        return version_;
+    }
+
     [[nodiscard]] auto begin() const noexcept -> const_iterator_type {
         return {internal_.begin(), internal_.end()};
     }
@@ -561,37 +766,152 @@ class directed_weighted_graph {
     // Helper function for copy-and-swap idiom.
     auto swap(directed_weighted_graph& g) noexcept -> directed_weighted_graph& {
         internal_.swap(g.internal_);
+        std::swap(version_, g.version_);
         return *this;
     }
 
     [[nodiscard]] auto find_node(std::shared_ptr<N> const& node) const noexcept
         -> graph_type::const_iterator {
+        XTD_GRAPH_STATS_ADD(node_lookups, 1);
         return internal_.find(node);
     }
 
     auto find_node(std::shared_ptr<N> const& node) noexcept -> graph_type::iterator {
+        XTD_GRAPH_STATS_ADD(node_lookups, 1);
         return internal_.find(node);
     }
 
     [[nodiscard]] auto find_node(N const& node) const noexcept -> graph_type::const_iterator {
+        XTD_GRAPH_STATS_ADD(allocations, 1);
         return find_node(std::make_shared<N>(node));
     }
 
     auto find_node(N const& node) noexcept -> graph_type::iterator {
+        XTD_GRAPH_STATS_ADD(allocations, 1);
         return find_node(std::make_shared<N>(node));
     }
 
     [[nodiscard]] auto find_node(std::weak_ptr<N> const& node) const noexcept
         -> graph_type::const_iterator {
+        XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
         return find_node(node.lock());
     }
 
     auto find_node(std::weak_ptr<N> const& node) noexcept -> graph_type::iterator {
+        XTD_GRAPH_STATS_ADD(weak_ptr_locks, 1);
         return find_node(node.lock());
     }
 
+    auto make_snapshot() const -> version_type {
+        XTD_GRAPH_STATS_PHASE("snapshot");
+        auto snapshot = std::make_shared<snapshot_type>();
+        auto indices = std::unordered_map<N const*, size_type>();
+        snapshot->nodes.reserve(internal_.size());
+        snapshot->offsets.reserve(internal_.size() + 1);
+        for (auto const& k : internal_ | std::views::keys) {
+            indices.emplace(k.get(), snapshot->nodes.size());
+            snapshot->nodes.push_back(*k);
+        }
+
+        snapshot->offsets.push_back(0);
+        for (auto const& v : internal_ | std::views::values) {
+            XTD_GRAPH_STATS_ADD(edges_scanned, v.size());
+            XTD_GRAPH_STATS_ADD(weak_ptr_locks, v.size());
+            for (auto const& [n, w] : v) {
+                snapshot->targets.push_back(indices.at(n.lock().get()));
+                snapshot->weights.push_back(w);
+            }
+            snapshot->offsets.push_back(snapshot->targets.size());
+        }
+        return snapshot;
+    }
+
+    // Applies the operations staged in b. Edges are ordered by source node so that each affected
+    // edge set is rebuilt once by merging it with its staged edges.
+    auto apply(batch_type& b) -> void {
+        XTD_GRAPH_STATS_PHASE("batch");
+        auto& staged = b.edges_;
+        auto inserted = std::set<N>(b.inserted_nodes_.begin(), b.inserted_nodes_.end());
+
+        // Validate before mutating anything so that a failed commit leaves the graph untouched.
+        for (auto const& e : staged) {
+            if ((is_node(e.src) == false && inserted.contains(e.src) == false) ||
+                (is_node(e.dst) == false && inserted.contains(e.dst) == false)) {
+                throw std::runtime_error(
+                    "Cannot call xtd::directed_weighted_graph<N, E>::batch_type::commit when "
+                    "either src or dst node of a staged edge does not exist");
+            }
+        }
+
+        for (auto const& value : inserted) {
+            insert_node(value);
+        }
+
+        // Stable sort so that the last operation staged for an edge is last in its run.
+        auto edge_less = [](auto const& lhs, auto const& rhs) {
+            return std::tie(lhs.src, lhs.dst, lhs.weight) < std::tie(rhs.src, rhs.dst, rhs.weight);
+        };
+        std::stable_sort(staged.begin(), staged.end(), edge_less);
+
+        for (auto first = staged.begin(); first != staged.end();) {
+            auto last = std::find_if(first, staged.end(),
+                                     [&first](auto const& e) { return first->src < e.src; });
+            auto& edges = find_node(first->src)->second;
+            auto merged = edges_type();
+            auto old = edges.begin();
+
+            while (first != last) {
+                // Collapse repeated operations on the same edge into the last one staged.
+                auto op = first;
+                while (++first != last && !edge_less(*op, *first)) {
+                    op = first;
+                }
+
+                // Keep existing edges that sort before the staged one.
+                auto old_less = [&op](auto const& pair) {
+                    auto const& to = *pair.first.lock();
+                    return to < op->dst || (!(op->dst < to) && pair.second < op->weight);
+                };
+                for (; old != edges.end() && old_less(*old); ++old) {
+                    merged.emplace_hint(merged.end(), *old);
+                }
+
+                // Drop the existing equivalent edge, if any, and let the staged operation decide.
+                if (old != edges.end() && !(op->dst < *old->first.lock()) &&
+                    !(op->weight < old->second)) {
+                    ++old;
+                }
+                if (op->insert) {
+                    merged.emplace_hint(merged.end(), find_node(op->dst)->first, op->weight);
+                }
+            }
+            merged.insert(old, edges.end());
+            edges.swap(merged);
+        }
+
+        if (b.erased_nodes_.empty() == false) {
+            auto erased = std::set<N>(b.erased_nodes_.begin(), b.erased_nodes_.end());
+            for (auto& v : internal_ | std::views::values) {
+                std::erase_if(v, [&erased](auto const& pair) {
+                    return erased.contains(*pair.first.lock());
+                });
+            }
+            for (auto const& value : erased) {
+                if (auto it = find_node(value); it != internal_.end()) {
+                    internal_.erase(it);
+                }
+            }
+        }
+
+        version_.reset();
+    }
+
     // Internal data structure uses a map to represent the directed_weighted_graph.
     graph_type internal_;
+
+    // Version built by the last call to snapshot(), or nullptr if the graph has changed since. Not
+    // atomic, as snapshot() may not race with itself or with any mutation anyway.
+    mutable version_type version_;
 };
 
 }  // namespace xtd
\ No newline at end of file
@@ -0,0 +1,214 @@
+/**
+ * Opt-in instrumentation for graphs and graph traversals.
+ *
+ * Counting is compiled in only when XTD_GRAPH_STATS is defined before the first graph header is
+ * included. Otherwise the XTD_GRAPH_STATS_* macros expand to nothing and instrumentation costs
+ * nothing.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xtd {
+
+namespace detail {
+
+struct graph_stats_record;
+
+}  // namespace detail
+
+// Counters are kept per thread, so instrumented code never contends on them, and every thread's
+// counters are registered so that any thread can scrape them. local() reads the calling thread's
+// counters; total() sums those of every thread, including worker threads and threads that have
+// since exited, and may be called from a monitoring thread while the others keep counting.
+struct graph_stats {
+    std::size_t node_lookups = 0;    // Searches of the node map.
+    std::size_t edges_scanned = 0;   // Edges visited by queries and traversals.
+    std::size_t allocations = 0;     // Heap allocations of temporary nodes and values.
+    std::size_t weak_ptr_locks = 0;  // Edge destinations resolved through std::weak_ptr::lock.
+    std::vector<std::size_t> frontier_sizes;                     // Nodes enqueued per level.
+    std::map<std::string, std::chrono::nanoseconds> phase_times;  // Time spent per named phase.
+
+    // Returns the counters of the calling thread.
+    static auto local() -> graph_stats;
+
+    // Returns the counters of every thread added together.
+    static auto total() -> graph_stats;
+
+    // Zeroes the counters of the calling thread.
+    static auto reset_local() -> void;
+
+    // Zeroes the counters of every thread.
+    static auto reset_total() -> void;
+
+    // Adds n to the calling thread's counter.
+    static auto add(std::size_t graph_stats::*counter, std::size_t n) noexcept -> void;
+
+    // Adds n nodes to the calling thread's frontier at level.
+    static auto add_frontier(std::size_t level, std::size_t n) -> void;
+
+    auto reset() -> void { *this = graph_stats(); }
+
+    auto operator+=(graph_stats const& other) -> graph_stats& {
+        node_lookups += other.node_lookups;
+        edges_scanned += other.edges_scanned;
+        allocations += other.allocations;
+        weak_ptr_locks += other.weak_ptr_locks;
+        if (frontier_sizes.size() < other.frontier_sizes.size()) frontier_sizes.resize(other.frontier_sizes.size(), 0);
+        for (std::size_t level = 0; level < other.frontier_sizes.size(); ++level) {
+            frontier_sizes[level] += other.frontier_sizes[level];
+        }
+        for (auto const& [name, time] : other.phase_times) phase_times[name] += time;
+        return *this;
+    }
+
+    // Adds the time between construction and destruction to phase_times[name].
+    class scoped_phase {
+       public:
+        explicit scoped_phase(char const* name)
+            : name_(name), start_(std::chrono::steady_clock::now()) {}
+
+        scoped_phase(scoped_phase const&) = delete;
+        auto operator=(scoped_phase const&) -> scoped_phase& = delete;
+
+        ~scoped_phase();
+
+       private:
+        char const* name_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+   private:
+    friend struct detail::graph_stats_record;
+
+    static constexpr std::size_t graph_stats::*counters[] = {
+        &graph_stats::node_lookups, &graph_stats::edges_scanned, &graph_stats::allocations,
+        &graph_stats::weak_ptr_locks};
+};
+
+namespace detail {
+
+// The counters of one thread. Only that thread adds to them, but any thread may read or reset them:
+// the scalar counters are accessed atomically, and the frontier sizes and phase times under mutex,
+// which their owner only takes once per level or phase.
+struct graph_stats_record {
+    graph_stats_record() {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        r.live.push_back(this);
+    }
+
+    // Hands the counters of an exiting thread on to the registry, so that total() still counts them.
+    ~graph_stats_record() {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        r.retired += read();
+        std::erase(r.live, this);
+    }
+
+    graph_stats_record(graph_stats_record const&) = delete;
+    auto operator=(graph_stats_record const&) -> graph_stats_record& = delete;
+
+    static auto local() -> graph_stats_record& {
+        thread_local auto record = graph_stats_record();
+        return record;
+    }
+
+    auto read() const -> graph_stats {
+        auto result = graph_stats();
+        for (auto counter : graph_stats::counters) {
+            result.*counter = std::atomic_ref(stats.*counter).load(std::memory_order_relaxed);
+        }
+        std::lock_guard lock(mutex);
+        result.frontier_sizes = stats.frontier_sizes;
+        result.phase_times = stats.phase_times;
+        return result;
+    }
+
+    auto reset() -> void {
+        for (auto counter : graph_stats::counters) {
+            std::atomic_ref(stats.*counter).store(0, std::memory_order_relaxed);
+        }
+        std::lock_guard lock(mutex);
+        stats.frontier_sizes.clear();
+        stats.phase_times.clear();
+    }
+
+    // Every live thread's record, and the sum of the counters of threads that have exited.
+    struct registry_type {
+        std::mutex mutex;
+        std::vector<graph_stats_record*> live;
+        graph_stats retired;
+    };
+
+    // Constructed by the first record, so it outlives every record.
+    static auto registry() -> registry_type& {
+        static auto r = registry_type();
+        return r;
+    }
+
+    mutable std::mutex mutex;
+    graph_stats stats;
+};
+
+}  // namespace detail
+
+inline auto graph_stats::local() -> graph_stats { return detail::graph_stats_record::local().read(); }
+
+inline auto graph_stats::total() -> graph_stats {
+    auto& r = detail::graph_stats_record::registry();
+    std::lock_guard lock(r.mutex);
+    auto result = r.retired;
+    for (auto const* record : r.live) result += record->read();
+    return result;
+}
+
+inline auto graph_stats::reset_local() -> void { detail::graph_stats_record::local().reset(); }
+
+inline auto graph_stats::reset_total() -> void {
+    auto& r = detail::graph_stats_record::registry();
+    std::lock_guard lock(r.mutex);
+    r.retired.reset();
+    for (auto* record : r.live) record->reset();
+}
+
+inline auto graph_stats::add(std::size_t graph_stats::*counter, std::size_t n) noexcept -> void {
+    std::atomic_ref(detail::graph_stats_record::local().stats.*counter).fetch_add(n, std::memory_order_relaxed);
+}
+
+inline auto graph_stats::add_frontier(std::size_t level, std::size_t n) -> void {
+    if (n == 0) return;
+    auto& record = detail::graph_stats_record::local();
+    std::lock_guard lock(record.mutex);
+    auto& frontier_sizes = record.stats.frontier_sizes;
+    if (frontier_sizes.size() <= level) frontier_sizes.resize(level + 1, 0);
+    frontier_sizes[level] += n;
+}
+
+inline graph_stats::scoped_phase::~scoped_phase() {
+    auto const elapsed = std::chrono::steady_clock::now() - start_;
+    auto& record = detail::graph_stats_record::local();
+    std::lock_guard lock(record.mutex);
+    record.stats.phase_times[name_] += elapsed;
+}
+
+}  // namespace xtd
+
+#ifdef XTD_GRAPH_STATS
+#define XTD_GRAPH_STATS_ADD(counter, n) (::xtd::graph_stats::add(&::xtd::graph_stats::counter, (n)))
+#define XTD_GRAPH_STATS_FRONTIER(level, n) (::xtd::graph_stats::add_frontier((level), (n)))
+#define XTD_GRAPH_STATS_PHASE(name) \
+    auto const xtd_graph_stats_phase_ = ::xtd::graph_stats::scoped_phase(name)
+#else
+#define XTD_GRAPH_STATS_ADD(counter, n) ((void)0)
+#define XTD_GRAPH_STATS_FRONTIER(level, n) ((void)0)
+#define XTD_GRAPH_STATS_PHASE(name) ((void)0)
+#endif
@@ -771,3 +771,92 @@ TEST(directed_weighted_graph, stab_operator) {
     EXPECT_EQ(2, it->to);
     EXPECT_EQ(4, it->weight);
 }
+
+TEST(directed_weighted_graph, snapshot_of_graph) {
+    auto g = xtd::directed_weighted_graph<int, int>({3, 2, 1});
+    g.insert_edge(1, 3, 5);
+    g.insert_edge(1, 2, 4);
+    g.insert_edge(1, 2, 3);
+    g.insert_edge(3, 1, 7);
+    auto v = g.snapshot();
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), v->nodes);
+    EXPECT_EQ(std::vector<std::size_t>({0, 3, 3, 4}), v->offsets);
+    EXPECT_EQ(std::vector<std::size_t>({1, 1, 2, 0}), v->targets);
+    EXPECT_EQ(std::vector<int>({3, 4, 5, 7}), v->weights);
+    EXPECT_EQ(2, v->index(3));
+    EXPECT_EQ(3, v->index(4));
+}
+
+TEST(directed_weighted_graph, batch_commit) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(1, 3, 1);
+    auto b = g.batch();
+    b.insert_node(4).insert_edge(1, 4, 1).insert_edge(4, 1, 2).erase_edge(1, 3, 1);
+    b.insert_edge(2, 3, 1).erase_edge(2, 3, 1).insert_edge(1, 2, 0);
+    EXPECT_EQ(7, b.size());
+    b.commit();
+    EXPECT_EQ(0, b.size());
+    EXPECT_NE(g.end(), g.find(1, 2, 0));
+    EXPECT_NE(g.end(), g.find(1, 2, 1));
+    EXPECT_FALSE(g.is_connected(1, 3));
+    EXPECT_TRUE(g.is_connected(1, 4));
+    EXPECT_TRUE(g.is_connected(4, 1));
+    EXPECT_FALSE(g.is_connected(2, 3));
+}
+
+TEST(directed_weighted_graph, batch_erase_node) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(2, 3, 1);
+    g.batch().erase_node(2).insert_edge(1, 3, 1).commit();
+    EXPECT_FALSE(g.is_node(2));
+    EXPECT_EQ(std::vector<int>({3}), g.connections(1));
+}
+
+TEST(directed_weighted_graph, batch_with_missing_node) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2});
+    auto b = g.batch();
+    b.insert_edge(1, 2, 1).insert_edge(1, 3, 1);
+    EXPECT_THROW(b.commit(), std::runtime_error);
+    EXPECT_FALSE(g.is_connected(1, 2));
+}
+
+TEST(directed_weighted_graph, old_versions_stay_readable) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2});
+    g.batch().insert_edge(1, 2, 1).commit();
+    auto v1 = g.snapshot();
+    g.batch().erase_edge(1, 2, 1).insert_node(3).commit();
+    auto v2 = g.snapshot();
+    EXPECT_EQ(v2, g.snapshot());
+    EXPECT_EQ(1, v1->edge_count());
+    EXPECT_EQ(2, v1->size());
+    EXPECT_EQ(0, v2->edge_count());
+    EXPECT_EQ(3, v2->size());
+    g.insert_edge(2, 1, 1);
+    EXPECT_NE(v2, g.snapshot());
+    EXPECT_EQ(0, v2->edge_count());
+}
+
+TEST(directed_weighted_graph, commit_publishes_on_next_snapshot) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    auto const before = g.snapshot();
+    g.batch().insert_edge(1, 2, 1).commit();
+    g.batch().insert_edge(2, 3, 1).commit();
+    auto const after = g.snapshot();
+    EXPECT_EQ(0, before->edge_count());
+    EXPECT_EQ(2, after->edge_count());
+    EXPECT_EQ(after, g.snapshot());
+}
+
+TEST(directed_weighted_graph, copy_assignment_replaces_published_version) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2});
+    g.batch().insert_edge(1, 2, 1).commit();
+    auto const old = g.snapshot();
+    auto const h = xtd::directed_weighted_graph<int, int>({3, 4, 5});
+    g = h;
+    EXPECT_EQ(3, g.snapshot()->size());
+    EXPECT_EQ(0, g.snapshot()->edge_count());
+    EXPECT_EQ(2, old->size());
+    EXPECT_EQ(1, old->edge_count());
+}
@@ -0,0 +1,79 @@
+/**
+ * k-core decomposition over a graph interpreted as undirected.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <vector>
+
+namespace xtd {
+
+/**
+ * Returns the core number of every node of a compact snapshot, interpreted as undirected, indexed
+ * the same way as the snapshot's nodes. The k-core of the graph is the set of nodes whose core
+ * number is at least k.
+ *
+ * Uses bucket-based peeling (Batagelj and Zaversnik): nodes are kept in an array sorted by their
+ * current degree, with the start of each degree bucket recorded, so that removing the node of
+ * least degree and decrementing its neighbours are each O(1). Initial degrees are computed in
+ * parallel.
+ *
+ * Complexity is O(n + e), where n is the number of nodes and e is the number of edges.
+ */
+template <typename Snapshot>
+auto k_core(Snapshot const& snapshot) -> std::vector<typename Snapshot::size_type> {
+    using size_type = typename Snapshot::size_type;
+    auto const graph = snapshot.undirected();
+    auto const n = graph.size();
+
+    auto degree = std::vector<size_type>(n);
+    std::transform(std::execution::par, graph.offsets.begin(), graph.offsets.end() - 1,
+                   graph.offsets.begin() + 1, degree.begin(),
+                   [](size_type first, size_type last) { return last - first; });
+    auto const max_degree = n == 0 ? size_type{0} : *std::max_element(degree.begin(), degree.end());
+
+    // Counting sort of the nodes by degree. bucket[d] is the position of the first node of
+    // degree d in order, and position[u] is the position of u in order.
+    auto bucket = std::vector<size_type>(max_degree + 2, 0);
+    for (auto d : degree) {
+        ++bucket[d + 1];
+    }
+    std::partial_sum(bucket.begin(), bucket.end(), bucket.begin());
+    auto order = std::vector<size_type>(n);
+    auto position = std::vector<size_type>(n);
+    {
+        auto next = bucket;
+        for (size_type u = 0; u < n; ++u) {
+            position[u] = next[degree[u]]++;
+            order[position[u]] = u;
+        }
+    }
+
+    for (size_type i = 0; i < n; ++i) {
+        auto const u = order[i];
+        for (auto e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            auto const v = graph.targets[e];
+            if (degree[v] > degree[u]) {
+                // Swap v with the first node of its bucket, then shrink the bucket past it.
+                auto const w = order[bucket[degree[v]]];
+                if (v != w) {
+                    std::swap(order[position[v]], order[bucket[degree[v]]]);
+                    std::swap(position[v], position[w]);
+                }
+                ++bucket[degree[v]];
+                --degree[v];
+            }
+        }
+    }
+    return degree;
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto k_core(Graph<N, E> const& graph) -> std::vector<typename Graph<N, E>::size_type> {
+    return k_core(*graph.snapshot());
+}
+
+}  // namespace xtd
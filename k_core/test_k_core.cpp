@@ -0,0 +1,38 @@
+#include "directed_weighted_graph.hpp"
+#include "gtest/gtest.h"
+#include "k_core.hpp"
+
+TEST(k_core, empty_graph) {
+    auto g = xtd::directed_weighted_graph<int, int>();
+    EXPECT_TRUE(xtd::k_core(g).empty());
+}
+
+TEST(k_core, isolated_nodes) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    EXPECT_EQ(std::vector<std::size_t>({0, 0, 0}), xtd::k_core(g));
+}
+
+TEST(k_core, triangle_with_tail) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3, 4, 5});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(2, 3, 1);
+    g.insert_edge(3, 1, 1);
+    g.insert_edge(3, 4, 1);
+    g.insert_edge(4, 3, 1);
+    g.insert_edge(4, 5, 1);
+    EXPECT_EQ(std::vector<std::size_t>({2, 2, 2, 1, 1}), xtd::k_core(g));
+}
+
+TEST(k_core, clique_joined_to_cycle) {
+    auto g = xtd::directed_weighted_graph<int, int>({0, 1, 2, 3, 4, 5, 6});
+    for (auto u = 0; u < 4; ++u) {
+        for (auto v = u + 1; v < 4; ++v) {
+            g.insert_edge(u, v, 1);
+        }
+    }
+    g.insert_edge(3, 4, 1);
+    g.insert_edge(4, 5, 1);
+    g.insert_edge(5, 6, 1);
+    g.insert_edge(6, 4, 1);
+    EXPECT_EQ(std::vector<std::size_t>({3, 3, 3, 3, 2, 2, 2}), xtd::k_core(g));
+}
@@ -0,0 +1,362 @@
+/**
+ * Maximum flow and minimum cut algorithms, where edge weights are capacities.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace xtd {
+
+template <typename N, typename E>
+struct flow_result {
+    E value;                    // Value of the maximum flow.
+    std::vector<N> source_side; // Nodes on the source side of a minimum cut, in ascending order.
+    std::vector<N> sink_side;   // Nodes on the sink side of a minimum cut, in ascending order.
+};
+
+namespace detail {
+
+// Residual graph in a flat layout: the arcs leaving node u occupy [offsets[u], offsets[u + 1]).
+// Every edge u → v becomes an arc u → v with its capacity and a paired arc v → u with capacity
+// zero, and reverse holds the index of the paired arc.
+template <typename E>
+struct residual_graph {
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> targets;
+    std::vector<std::size_t> reverse;
+    std::vector<E> capacities;
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return offsets.size() - 1; }
+
+    template <typename Snapshot>
+    explicit residual_graph(Snapshot const& snapshot) : offsets(snapshot.size() + 1, 0) {
+        auto const n = snapshot.size();
+        for (std::size_t u = 0; u < n; ++u) {
+            for (auto e = snapshot.offsets[u]; e < snapshot.offsets[u + 1]; ++e) {
+                if (snapshot.weights[e] < E{}) {
+                    throw std::runtime_error(
+                        "Cannot compute xtd::maximum_flow on a graph with a negative capacity");
+                }
+                if (snapshot.targets[e] != u) {
+                    ++offsets[u + 1];
+                    ++offsets[snapshot.targets[e] + 1];
+                }
+            }
+        }
+        for (std::size_t u = 0; u < n; ++u) {
+            offsets[u + 1] += offsets[u];
+        }
+
+        targets.resize(offsets.back());
+        reverse.resize(offsets.back());
+        capacities.resize(offsets.back());
+        auto next = std::vector<std::size_t>(offsets.begin(), offsets.end() - 1);
+        for (std::size_t u = 0; u < n; ++u) {
+            for (auto e = snapshot.offsets[u]; e < snapshot.offsets[u + 1]; ++e) {
+                auto const v = snapshot.targets[e];
+                if (v != u) {
+                    auto const a = next[u]++;
+                    auto const b = next[v]++;
+                    targets[a] = v;
+                    targets[b] = u;
+                    reverse[a] = b;
+                    reverse[b] = a;
+                    capacities[a] = snapshot.weights[e];
+                    capacities[b] = E{};
+                }
+            }
+        }
+    }
+
+    // Breadth-first search from root over arcs with residual capacity. If backward is true, the
+    // search follows arcs in reverse, i.e. it finds the nodes that can reach root. Nodes for which
+    // skip returns true are neither labelled nor expanded.
+    //
+    // Returns the distance of every labelled node, and npos for the remaining ones.
+    template <typename Skip>
+    auto distances(std::size_t root, bool backward, Skip skip) const -> std::vector<std::size_t> {
+        auto distance = std::vector<std::size_t>(size(), npos);
+        auto queue = std::vector<std::size_t>({root});
+        distance[root] = 0;
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            auto const u = queue[i];
+            for (auto a = offsets[u]; a < offsets[u + 1]; ++a) {
+                auto const v = targets[a];
+                auto const open = capacities[backward ? reverse[a] : a] > E{};
+                if (open && distance[v] == npos && !skip(v)) {
+                    distance[v] = distance[u] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        return distance;
+    }
+
+    // Returns value together with the minimum cut given by the nodes reachable from s.
+    template <typename Snapshot>
+    auto result(Snapshot const& snapshot, std::size_t s, E value) const
+        -> flow_result<typename Snapshot::node_value_type, E> {
+        auto reachable = distances(s, false, [](std::size_t) { return false; });
+        auto r = flow_result<typename Snapshot::node_value_type, E>{value, {}, {}};
+        for (std::size_t u = 0; u < size(); ++u) {
+            (reachable[u] != npos ? r.source_side : r.sink_side).push_back(snapshot.nodes[u]);
+        }
+        return r;
+    }
+
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+};
+
+template <typename Snapshot>
+using flow_result_t = flow_result<typename Snapshot::node_value_type, typename Snapshot::weight_type>;
+
+template <typename Snapshot, typename N>
+auto terminals(Snapshot const& snapshot, N const& source, N const& sink)
+    -> std::pair<std::size_t, std::size_t> {
+    auto const s = snapshot.index(source);
+    auto const t = snapshot.index(sink);
+    if (s == snapshot.size() || t == snapshot.size() || s == t) {
+        throw std::runtime_error(
+            "Cannot compute xtd::maximum_flow unless source and sink are distinct nodes of the "
+            "graph");
+    }
+    return {s, t};
+}
+
+}  // namespace detail
+
+/**
+ * FIFO push-relabel maximum flow with the global relabelling and gap heuristics.
+ *
+ * Heights are periodically recomputed exactly by a backward breadth-first search from the sink
+ * (and, for nodes that can no longer reach it, from the source). When a relabel empties a height
+ * below n, every node above that gap is lifted out of reach of the sink at once.
+ *
+ * Complexity is O(n^3), where n is the number of nodes, and usually far less in practice.
+ *
+ * Throws std::runtime_error if source or sink is not a node, if they are equal, or if any edge
+ * has a negative capacity.
+ */
+template <typename Snapshot, typename N>
+auto push_relabel(Snapshot const& snapshot, N const& source, N const& sink)
+    -> detail::flow_result_t<Snapshot> {
+    using E = typename Snapshot::weight_type;
+    auto const [s, t] = detail::terminals(snapshot, source, sink);
+    auto graph = detail::residual_graph<E>(snapshot);
+    auto const n = graph.size();
+    auto constexpr npos = detail::residual_graph<E>::npos;
+
+    auto height = std::vector<std::size_t>(n, 0);
+    auto excess = std::vector<E>(n, E{});
+    auto current = std::vector<std::size_t>(graph.offsets.begin(), graph.offsets.end() - 1);
+    auto count = std::vector<std::size_t>(2 * n + 1, 0);
+    auto active = std::queue<std::size_t>();
+    auto queued = std::vector<bool>(n, false);
+
+    auto activate = [&](std::size_t v) {
+        if (!queued[v] && v != s && v != t && excess[v] > E{}) {
+            queued[v] = true;
+            active.push(v);
+        }
+    };
+
+    auto push = [&](std::size_t u, std::size_t a) {
+        auto const delta = std::min(excess[u], graph.capacities[a]);
+        graph.capacities[a] -= delta;
+        graph.capacities[graph.reverse[a]] += delta;
+        excess[u] -= delta;
+        excess[graph.targets[a]] += delta;
+        activate(graph.targets[a]);
+    };
+
+    auto global_relabel = [&]() {
+        auto to_sink = graph.distances(t, true, [](std::size_t) { return false; });
+        auto to_source = graph.distances(s, true, [&](std::size_t v) { return to_sink[v] != npos; });
+        std::fill(count.begin(), count.end(), 0);
+        for (std::size_t v = 0; v < n; ++v) {
+            height[v] = to_sink[v] != npos     ? to_sink[v]
+                        : to_source[v] != npos ? n + to_source[v]
+                                               : 2 * n;
+            ++count[height[v]];
+            current[v] = graph.offsets[v];
+        }
+        --count[height[s]];
+        height[s] = n;
+        ++count[n];
+    };
+
+    auto relabel = [&](std::size_t u) {
+        auto const old = height[u];
+        auto lowest = 2 * n;
+        for (auto a = graph.offsets[u]; a < graph.offsets[u + 1]; ++a) {
+            if (graph.capacities[a] > E{}) {
+                lowest = std::min(lowest, height[graph.targets[a]] + 1);
+            }
+        }
+        --count[old];
+        height[u] = lowest;
+        ++count[height[u]];
+        current[u] = graph.offsets[u];
+
+        // Gap: no node remains at height old, so nodes above it can no longer reach the sink.
+        if (old < n && count[old] == 0) {
+            for (std::size_t v = 0; v < n; ++v) {
+                if (v != s && height[v] > old && height[v] < n) {
+                    --count[height[v]];
+                    height[v] = n + 1;
+                    ++count[height[v]];
+                    current[v] = graph.offsets[v];
+                }
+            }
+        }
+    };
+
+    for (auto a = graph.offsets[s]; a < graph.offsets[s + 1]; ++a) {
+        excess[s] = graph.capacities[a];
+        push(s, a);
+    }
+    excess[s] = E{};
+    global_relabel();
+
+    // Recompute heights after roughly as much relabelling work as a global relabel costs.
+    auto const period = 6 * n + graph.targets.size();
+    auto work = std::size_t{0};
+    while (!active.empty()) {
+        auto const u = active.front();
+        active.pop();
+        queued[u] = false;
+
+        while (excess[u] > E{} && height[u] < 2 * n) {
+            if (current[u] == graph.offsets[u + 1]) {
+                relabel(u);
+                work += graph.offsets[u + 1] - graph.offsets[u] + 12;
+                continue;
+            }
+            auto const a = current[u];
+            if (graph.capacities[a] > E{} && height[u] == height[graph.targets[a]] + 1) {
+                push(u, a);
+            } else {
+                ++current[u];
+            }
+        }
+
+        if (work > period) {
+            work = 0;
+            global_relabel();
+        }
+    }
+
+    return graph.result(snapshot, s, excess[t]);
+}
+
+/**
+ * Dinic's maximum flow: repeatedly builds the level graph of shortest residual paths from the
+ * source, then saturates it with a blocking flow found by depth-first search with current-arc
+ * pointers.
+ *
+ * Complexity is O(n^2 e), where n is the number of nodes and e is the number of edges.
+ *
+ * Throws std::runtime_error if source or sink is not a node, if they are equal, or if any edge
+ * has a negative capacity.
+ */
+template <typename Snapshot, typename N>
+auto dinic(Snapshot const& snapshot, N const& source, N const& sink)
+    -> detail::flow_result_t<Snapshot> {
+    using E = typename Snapshot::weight_type;
+    auto const [s, t] = detail::terminals(snapshot, source, sink);
+    auto graph = detail::residual_graph<E>(snapshot);
+    auto constexpr npos = detail::residual_graph<E>::npos;
+
+    auto value = E{};
+    auto path = std::vector<std::size_t>();  // Arcs from s to the top of the search.
+    while (true) {
+        auto const level = graph.distances(s, false, [](std::size_t) { return false; });
+        if (level[t] == npos) {
+            break;
+        }
+        auto current = std::vector<std::size_t>(graph.offsets.begin(), graph.offsets.end() - 1);
+
+        // Iterative depth-first search, so that long paths cannot overflow the stack.
+        path.clear();
+        auto u = s;
+        while (true) {
+            if (u == t) {
+                auto delta = graph.capacities[path.front()];
+                for (auto a : path) {
+                    delta = std::min(delta, graph.capacities[a]);
+                }
+                for (auto a : path) {
+                    graph.capacities[a] -= delta;
+                    graph.capacities[graph.reverse[a]] += delta;
+                }
+                value += delta;
+                // Retreat to the tail of the first saturated arc.
+                auto const first = std::find_if(path.begin(), path.end(), [&](std::size_t a) {
+                    return !(graph.capacities[a] > E{});
+                });
+                path.erase(first, path.end());
+                u = path.empty() ? s : graph.targets[path.back()];
+                continue;
+            }
+
+            auto& a = current[u];
+            while (a < graph.offsets[u + 1] && !(graph.capacities[a] > E{} &&
+                                                 level[graph.targets[a]] == level[u] + 1)) {
+                ++a;
+            }
+            if (a < graph.offsets[u + 1]) {
+                path.push_back(a);
+                u = graph.targets[a];
+            } else if (u == s) {
+                break;
+            } else {
+                // Dead end: retreat and skip the arc that led here.
+                path.pop_back();
+                u = path.empty() ? s : graph.targets[path.back()];
+                ++current[u];
+            }
+        }
+    }
+
+    return graph.result(snapshot, s, value);
+}
+
+/**
+ * Computes a maximum flow from source to sink and a minimum cut separating them.
+ *
+ * Uses push_relabel for integral capacities and falls back to dinic for floating point ones,
+ * where push-relabel can keep moving vanishingly small excesses back and forth.
+ */
+template <typename Snapshot, typename N>
+auto maximum_flow(Snapshot const& snapshot, N const& source, N const& sink)
+    -> detail::flow_result_t<Snapshot> {
+    if constexpr (std::is_integral_v<typename Snapshot::weight_type>) {
+        return push_relabel(snapshot, source, sink);
+    } else {
+        return dinic(snapshot, source, sink);
+    }
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto push_relabel(Graph<N, E> const& graph, N const& source, N const& sink) -> flow_result<N, E> {
+    return push_relabel(*graph.snapshot(), source, sink);
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto dinic(Graph<N, E> const& graph, N const& source, N const& sink) -> flow_result<N, E> {
+    return dinic(*graph.snapshot(), source, sink);
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto maximum_flow(Graph<N, E> const& graph, N const& source, N const& sink) -> flow_result<N, E> {
+    return maximum_flow(*graph.snapshot(), source, sink);
+}
+
+}  // namespace xtd
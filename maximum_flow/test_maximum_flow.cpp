@@ -0,0 +1,100 @@
+#include <random>
+
+#include "directed_weighted_graph.hpp"
+#include "gtest/gtest.h"
+#include "maximum_flow.hpp"
+
+using graph_type = xtd::directed_weighted_graph<int, int>;
+
+namespace {
+
+// Sum of the capacities of edges crossing from the source side to the sink side.
+template <typename Graph, typename Result>
+auto cut_capacity(Graph const& g, Result const& r) {
+    auto capacity = decltype(r.value){};
+    for (auto const& [from, to, weight] : g) {
+        auto const in_source = std::binary_search(r.source_side.begin(), r.source_side.end(), from);
+        auto const in_sink = std::binary_search(r.sink_side.begin(), r.sink_side.end(), to);
+        if (in_source && in_sink) {
+            capacity += weight;
+        }
+    }
+    return capacity;
+}
+
+}  // namespace
+
+TEST(maximum_flow, missing_terminals) {
+    auto g = graph_type({1, 2});
+    EXPECT_THROW(xtd::maximum_flow(g, 1, 3), std::runtime_error);
+    EXPECT_THROW(xtd::maximum_flow(g, 1, 1), std::runtime_error);
+}
+
+TEST(maximum_flow, negative_capacity) {
+    auto g = graph_type({1, 2});
+    g.insert_edge(1, 2, -1);
+    EXPECT_THROW(xtd::maximum_flow(g, 1, 2), std::runtime_error);
+}
+
+TEST(maximum_flow, disconnected_terminals) {
+    auto g = graph_type({1, 2, 3});
+    g.insert_edge(1, 2, 5);
+    auto r = xtd::maximum_flow(g, 1, 3);
+    EXPECT_EQ(0, r.value);
+    EXPECT_EQ(std::vector<int>({1, 2}), r.source_side);
+    EXPECT_EQ(std::vector<int>({3}), r.sink_side);
+}
+
+TEST(maximum_flow, classic_network) {
+    auto g = graph_type({0, 1, 2, 3, 4, 5});
+    g.insert_edge(0, 1, 16);
+    g.insert_edge(0, 2, 13);
+    g.insert_edge(1, 2, 10);
+    g.insert_edge(2, 1, 4);
+    g.insert_edge(1, 3, 12);
+    g.insert_edge(3, 2, 9);
+    g.insert_edge(2, 4, 14);
+    g.insert_edge(4, 3, 7);
+    g.insert_edge(3, 5, 20);
+    g.insert_edge(4, 5, 4);
+    for (auto r : {xtd::push_relabel(g, 0, 5), xtd::dinic(g, 0, 5)}) {
+        EXPECT_EQ(23, r.value);
+        EXPECT_EQ(std::vector<int>({0, 1, 2, 4}), r.source_side);
+        EXPECT_EQ(std::vector<int>({3, 5}), r.sink_side);
+    }
+}
+
+TEST(maximum_flow, parallel_edges_and_floating_point_capacities) {
+    auto g = xtd::directed_weighted_graph<std::string, double>({"s", "a", "t"});
+    g.insert_edge("s", "a", 1.5);
+    g.insert_edge("s", "a", 2.0);
+    g.insert_edge("a", "t", 3.0);
+    g.insert_edge("a", "a", 9.0);
+    auto r = xtd::maximum_flow(g, std::string("s"), std::string("t"));
+    EXPECT_DOUBLE_EQ(3.0, r.value);
+    EXPECT_EQ(std::vector<std::string>({"a", "s"}), r.source_side);
+}
+
+TEST(maximum_flow, random_networks) {
+    auto engine = std::mt19937(7);
+    auto node = std::uniform_int_distribution<int>(0, 99);
+    auto capacity = std::uniform_int_distribution<int>(0, 20);
+    for (auto round = 0; round < 10; ++round) {
+        auto g = graph_type();
+        auto b = g.batch();
+        for (auto i = 0; i < 100; ++i) {
+            b.insert_node(i);
+        }
+        for (auto i = 0; i < 600; ++i) {
+            b.insert_edge(node(engine), node(engine), capacity(engine));
+        }
+        b.commit();
+        auto const version = g.snapshot();
+        auto const& snapshot = *version;
+        auto const expected = xtd::dinic(snapshot, 0, 99);
+        auto const actual = xtd::push_relabel(snapshot, 0, 99);
+        EXPECT_EQ(expected.value, actual.value);
+        EXPECT_EQ(expected.value, cut_capacity(g, expected));
+        EXPECT_EQ(actual.value, cut_capacity(g, actual));
+    }
+}
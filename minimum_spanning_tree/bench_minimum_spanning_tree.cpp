@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "directed_weighted_graph.hpp"
+#include "minimum_spanning_tree.hpp"
+
+// Time taken by Kruskal, Prim and Borůvka to find the minimum spanning forest of a random graph
+// with 10M edges over 1M nodes, or as many as given on the command line.
+//
+// The graph is built directly as a snapshot: inserting millions of edges one at a time into the
+// node-based directed_weighted_graph would take longer than the algorithms being measured.
+
+using Clock = std::chrono::steady_clock;
+using Graph = xtd::directed_weighted_graph<int, double>;
+
+// Returns a snapshot with n nodes and e edges between uniformly random nodes, with uniformly
+// random weights in [0, 1).
+auto random_snapshot(std::size_t n, std::size_t e) -> Graph::snapshot_type {
+    std::mt19937_64 random(42);
+    std::uniform_int_distribution<std::size_t> node(0, n - 1);
+    std::uniform_real_distribution<double> weight(0, 1);
+    std::vector<std::tuple<std::size_t, std::size_t, double>> edges(e);
+    for (auto& [from, to, w] : edges) {
+        from = node(random);
+        to = node(random);
+        w = weight(random);
+    }
+    std::sort(edges.begin(), edges.end());
+
+    Graph::snapshot_type snapshot;
+    snapshot.nodes.resize(n);
+    for (std::size_t i = 0; i < n; ++i) snapshot.nodes[i] = static_cast<int>(i);
+    snapshot.offsets.assign(n + 1, 0);
+    snapshot.targets.reserve(e);
+    snapshot.weights.reserve(e);
+    for (auto const& [from, to, w] : edges) {
+        ++snapshot.offsets[from + 1];
+        snapshot.targets.push_back(to);
+        snapshot.weights.push_back(w);
+    }
+    std::partial_sum(snapshot.offsets.begin(), snapshot.offsets.end(), snapshot.offsets.begin());
+    return snapshot;
+}
+
+template <typename Algorithm>
+auto measure(char const* name, Algorithm algorithm, Graph::snapshot_type const& snapshot) -> void {
+    auto const start = Clock::now();
+    auto const forest = algorithm(snapshot);
+    auto const elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    double total = 0;
+    for (auto const& edge : forest) total += edge.weight;
+    std::printf("%10s %12.1f %12zu %16.6f\n", name, elapsed, forest.size(), total);
+}
+
+int main(int argc, char** argv) {
+    auto const edges = argc > 1 ? std::stoul(argv[1]) : std::size_t{10'000'000};
+    auto const nodes = std::max<std::size_t>(2, edges / 10);
+    auto const snapshot = random_snapshot(nodes, edges);
+
+    std::printf("%zu nodes, %zu edges\n", nodes, edges);
+    std::printf("%10s %12s %12s %16s\n", "algorithm", "time (ms)", "edges", "weight");
+    measure("kruskal", [](auto const& s) { return xtd::kruskal(s); }, snapshot);
+    measure("prim", [](auto const& s) { return xtd::prim(s); }, snapshot);
+    measure("boruvka", [](auto const& s) { return xtd::boruvka(s); }, snapshot);
+}
@@ -0,0 +1,331 @@
+/**
+ * Minimum spanning forest algorithms over a graph interpreted as undirected.
+ *
+ * Every algorithm returns the edges of a minimum spanning forest as {from, to, weight} values,
+ * where from < to. Parallel edges are collapsed to the lightest one and self-loops are ignored.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <execution>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace xtd {
+
+/**
+ * Disjoint sets over the integers [0, n), with path compression and union by rank.
+ *
+ * Both operations run in amortised O(α(n)) time, where α is the inverse Ackermann function.
+ */
+class union_find {
+   public:
+    using size_type = std::size_t;
+
+    explicit union_find(size_type n) : parent_(n), rank_(n, 0) {
+        std::iota(parent_.begin(), parent_.end(), size_type{0});
+    }
+
+    // Returns the representative of the set containing x.
+    auto find(size_type x) -> size_type {
+        auto root = x;
+        while (parent_[root] != root) {
+            root = parent_[root];
+        }
+        // Point every node on the path directly at the root.
+        while (parent_[x] != root) {
+            x = std::exchange(parent_[x], root);
+        }
+        return root;
+    }
+
+    // Merges the sets containing a and b. Returns false if they were already the same set.
+    auto unite(size_type a, size_type b) -> bool {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return false;
+        }
+        if (rank_[a] < rank_[b]) {
+            std::swap(a, b);
+        }
+        parent_[b] = a;
+        if (rank_[a] == rank_[b]) {
+            ++rank_[a];
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto size() const noexcept -> size_type { return parent_.size(); }
+
+   private:
+    std::vector<size_type> parent_;
+    std::vector<unsigned char> rank_;
+};
+
+namespace detail {
+
+// Binary min-heap over the integers [0, n) keyed by K, which supports decreasing the key of an
+// element already in the heap.
+template <typename K>
+class indexed_heap {
+   public:
+    using size_type = std::size_t;
+
+    explicit indexed_heap(size_type n) : keys_(n), position_(n, npos) {}
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return heap_.empty(); }
+
+    [[nodiscard]] auto contains(size_type i) const noexcept -> bool { return position_[i] != npos; }
+
+    [[nodiscard]] auto key(size_type i) const noexcept -> K const& { return keys_[i]; }
+
+    // Inserts i with key k, or decreases the key of i to k if it is already in the heap and k is
+    // smaller. Returns true if the heap was modified.
+    auto push_or_decrease(size_type i, K const& k) -> bool {
+        if (contains(i) == false) {
+            keys_[i] = k;
+            position_[i] = heap_.size();
+            heap_.push_back(i);
+        } else if (k < keys_[i]) {
+            keys_[i] = k;
+        } else {
+            return false;
+        }
+        sift_up(position_[i]);
+        return true;
+    }
+
+    // Removes and returns the element with the least key.
+    auto pop() -> size_type {
+        auto const top = heap_.front();
+        swap(0, heap_.size() - 1);
+        heap_.pop_back();
+        position_[top] = npos;
+        if (heap_.empty() == false) {
+            sift_down(0);
+        }
+        return top;
+    }
+
+   private:
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    auto swap(size_type a, size_type b) -> void {
+        std::swap(heap_[a], heap_[b]);
+        position_[heap_[a]] = a;
+        position_[heap_[b]] = b;
+    }
+
+    auto sift_up(size_type i) -> void {
+        while (i > 0 && keys_[heap_[i]] < keys_[heap_[(i - 1) / 2]]) {
+            swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    auto sift_down(size_type i) -> void {
+        while (true) {
+            auto least = i;
+            for (auto child : {2 * i + 1, 2 * i + 2}) {
+                if (child < heap_.size() && keys_[heap_[child]] < keys_[heap_[least]]) {
+                    least = child;
+                }
+            }
+            if (least == i) {
+                return;
+            }
+            swap(i, least);
+            i = least;
+        }
+    }
+
+    std::vector<K> keys_;
+    std::vector<size_type> position_;
+    std::vector<size_type> heap_;
+};
+
+}  // namespace detail
+
+/**
+ * Kruskal's algorithm: edges are sorted by weight and added whenever they join two different
+ * trees of the forest.
+ *
+ * Complexity is O(e log (e)), where e is the number of edges.
+ */
+template <typename Snapshot>
+auto kruskal(Snapshot const& snapshot) -> std::vector<typename Snapshot::value_type> {
+    using size_type = typename Snapshot::size_type;
+    auto const graph = snapshot.undirected();
+
+    // Each undirected edge is stored in both directions; keep the u < v copy.
+    auto edges = std::vector<size_type>();
+    edges.reserve(graph.edge_count() / 2);
+    for (size_type u = 0; u < graph.size(); ++u) {
+        for (auto e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+            if (u < graph.targets[e]) {
+                edges.push_back(e);
+            }
+        }
+    }
+    std::stable_sort(edges.begin(), edges.end(), [&graph](size_type l, size_type r) {
+        return graph.weights[l] < graph.weights[r];
+    });
+
+    // Recover the source of an edge from its position by searching the offsets.
+    auto source = [&graph](size_type e) -> size_type {
+        return std::upper_bound(graph.offsets.begin(), graph.offsets.end(), e) -
+               graph.offsets.begin() - 1;
+    };
+
+    auto forest = std::vector<typename Snapshot::value_type>();
+    auto sets = union_find(graph.size());
+    for (auto e : edges) {
+        if (forest.size() + 1 >= graph.size()) {
+            break;
+        }
+        auto const u = source(e);
+        if (sets.unite(u, graph.targets[e])) {
+            forest.push_back({graph.nodes[u], graph.nodes[graph.targets[e]], graph.weights[e]});
+        }
+    }
+    return forest;
+}
+
+/**
+ * Prim's algorithm: each tree of the forest is grown from an unvisited node by repeatedly adding
+ * the lightest edge leaving the tree, found with an indexed heap.
+ *
+ * Complexity is O(e log (n)), where n is the number of nodes and e is the number of edges.
+ */
+template <typename Snapshot>
+auto prim(Snapshot const& snapshot) -> std::vector<typename Snapshot::value_type> {
+    using size_type = typename Snapshot::size_type;
+    using weight_type = typename decltype(snapshot.weights)::value_type;
+    auto const graph = snapshot.undirected();
+    auto const n = graph.size();
+
+    auto forest = std::vector<typename Snapshot::value_type>();
+    auto visited = std::vector<bool>(n, false);
+    auto parent = std::vector<size_type>(n);
+    auto heap = detail::indexed_heap<weight_type>(n);
+
+    for (size_type root = 0; root < n; ++root) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        auto u = root;
+        while (true) {
+            for (auto e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                auto const v = graph.targets[e];
+                if (visited[v] == false && heap.push_or_decrease(v, graph.weights[e])) {
+                    parent[v] = u;
+                }
+            }
+            if (heap.empty()) {
+                break;
+            }
+            u = heap.pop();
+            visited[u] = true;
+            auto const [from, to] = std::minmax(parent[u], u);
+            forest.push_back({graph.nodes[from], graph.nodes[to], heap.key(u)});
+        }
+    }
+    return forest;
+}
+
+/**
+ * Borůvka's algorithm: in every round, each tree of the forest selects its lightest outgoing
+ * edge, and all selected edges are added at once. The number of trees at least halves per round.
+ *
+ * The search for the lightest edge leaving each node runs in parallel. Ties between equal weights
+ * are broken by node indices so that concurrently selected edges never form a cycle.
+ *
+ * Complexity is O(e log (n)) work, where n is the number of nodes and e is the number of edges.
+ */
+template <typename Snapshot>
+auto boruvka(Snapshot const& snapshot) -> std::vector<typename Snapshot::value_type> {
+    using size_type = typename Snapshot::size_type;
+    auto const graph = snapshot.undirected();
+    auto const n = graph.size();
+
+    // Strict total order on edges, identified by their position in graph.
+    auto lighter = [&graph](size_type l, size_type r, size_type l_from, size_type r_from) {
+        return std::forward_as_tuple(graph.weights[l], std::min(l_from, graph.targets[l]),
+                                     std::max(l_from, graph.targets[l])) <
+               std::forward_as_tuple(graph.weights[r], std::min(r_from, graph.targets[r]),
+                                     std::max(r_from, graph.targets[r]));
+    };
+
+    auto forest = std::vector<typename Snapshot::value_type>();
+    auto sets = union_find(n);
+    auto nodes = std::vector<size_type>(n);
+    std::iota(nodes.begin(), nodes.end(), size_type{0});
+    auto component = nodes;
+    auto best = std::vector<std::optional<size_type>>(n);
+    auto cheapest = std::vector<std::optional<std::pair<size_type, size_type>>>(n);
+
+    for (auto merged = true; merged;) {
+        merged = false;
+
+        // Lightest edge leaving each node's component.
+        std::for_each(std::execution::par, nodes.begin(), nodes.end(), [&](size_type u) {
+            auto& b = best[u];
+            b.reset();
+            for (auto e = graph.offsets[u]; e < graph.offsets[u + 1]; ++e) {
+                if (component[graph.targets[e]] != component[u] &&
+                    (!b.has_value() || lighter(e, *b, u, u))) {
+                    b = e;
+                }
+            }
+        });
+
+        // Lightest edge leaving each component.
+        std::fill(cheapest.begin(), cheapest.end(), std::nullopt);
+        for (size_type u = 0; u < n; ++u) {
+            auto& c = cheapest[component[u]];
+            if (best[u].has_value() && (!c.has_value() || lighter(*best[u], c->first, u, c->second))) {
+                c = {{*best[u], u}};
+            }
+        }
+
+        for (auto const& c : cheapest) {
+            if (c.has_value()) {
+                auto const [e, u] = *c;
+                if (sets.unite(u, graph.targets[e])) {
+                    auto const [from, to] = std::minmax(u, graph.targets[e]);
+                    forest.push_back({graph.nodes[from], graph.nodes[to], graph.weights[e]});
+                    merged = true;
+                }
+            }
+        }
+
+        for (size_type u = 0; u < n; ++u) {
+            component[u] = sets.find(u);
+        }
+    }
+    return forest;
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto kruskal(Graph<N, E> const& graph) -> std::vector<typename Graph<N, E>::value_type> {
+    return kruskal(*graph.snapshot());
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto prim(Graph<N, E> const& graph) -> std::vector<typename Graph<N, E>::value_type> {
+    return prim(*graph.snapshot());
+}
+
+template <template <typename, typename> typename Graph, typename N, typename E>
+auto boruvka(Graph<N, E> const& graph) -> std::vector<typename Graph<N, E>::value_type> {
+    return boruvka(*graph.snapshot());
+}
+
+}  // namespace xtd
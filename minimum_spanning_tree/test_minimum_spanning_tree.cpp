@@ -0,0 +1,104 @@
+#include <random>
+
+#include "directed_weighted_graph.hpp"
+#include "gtest/gtest.h"
+#include "minimum_spanning_tree.hpp"
+
+using graph_type = xtd::directed_weighted_graph<int, int>;
+using forest_type = std::vector<graph_type::value_type>;
+
+namespace {
+
+auto sorted(forest_type forest) -> forest_type {
+    std::sort(forest.begin(), forest.end(),
+              [](auto const& l, auto const& r) { return (l <=> r) < 0; });
+    return forest;
+}
+
+auto total_weight(forest_type const& forest) -> int {
+    auto sum = 0;
+    for (auto const& e : forest) {
+        sum += e.weight;
+    }
+    return sum;
+}
+
+}  // namespace
+
+TEST(union_find, unite_and_find) {
+    auto sets = xtd::union_find(5);
+    EXPECT_TRUE(sets.unite(0, 1));
+    EXPECT_TRUE(sets.unite(3, 4));
+    EXPECT_FALSE(sets.unite(1, 0));
+    EXPECT_EQ(sets.find(0), sets.find(1));
+    EXPECT_NE(sets.find(1), sets.find(3));
+    EXPECT_TRUE(sets.unite(1, 4));
+    EXPECT_EQ(sets.find(0), sets.find(3));
+    EXPECT_NE(sets.find(0), sets.find(2));
+}
+
+TEST(minimum_spanning_tree, empty_graph) {
+    auto g = graph_type();
+    EXPECT_TRUE(xtd::kruskal(g).empty());
+    EXPECT_TRUE(xtd::prim(g).empty());
+    EXPECT_TRUE(xtd::boruvka(g).empty());
+}
+
+TEST(minimum_spanning_tree, spanning_tree) {
+    auto g = graph_type({1, 2, 3, 4});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(2, 3, 2);
+    g.insert_edge(3, 1, 3);
+    g.insert_edge(4, 3, 1);
+    g.insert_edge(1, 4, 5);
+    auto expected = forest_type({{1, 2, 1}, {2, 3, 2}, {3, 4, 1}});
+    EXPECT_EQ(expected, sorted(xtd::kruskal(g)));
+    EXPECT_EQ(expected, sorted(xtd::prim(g)));
+    EXPECT_EQ(expected, sorted(xtd::boruvka(g)));
+}
+
+TEST(minimum_spanning_tree, spanning_forest_with_parallel_edges_and_self_loops) {
+    auto g = graph_type({1, 2, 3, 4, 5});
+    g.insert_edge(1, 1, 0);
+    g.insert_edge(1, 2, 7);
+    g.insert_edge(2, 1, 4);
+    g.insert_edge(4, 5, 2);
+    g.insert_edge(4, 5, 3);
+    auto expected = forest_type({{1, 2, 4}, {4, 5, 2}});
+    EXPECT_EQ(expected, sorted(xtd::kruskal(g)));
+    EXPECT_EQ(expected, sorted(xtd::prim(g)));
+    EXPECT_EQ(expected, sorted(xtd::boruvka(g)));
+}
+
+TEST(minimum_spanning_tree, equal_weights) {
+    auto g = graph_type({0, 1, 2, 3});
+    for (auto u = 0; u < 4; ++u) {
+        for (auto v = 0; v < 4; ++v) {
+            g.insert_edge(u, v, 1);
+        }
+    }
+    EXPECT_EQ(3, xtd::kruskal(g).size());
+    EXPECT_EQ(3, xtd::prim(g).size());
+    EXPECT_EQ(3, xtd::boruvka(g).size());
+}
+
+TEST(minimum_spanning_tree, random_graph) {
+    auto engine = std::mt19937(42);
+    auto node = std::uniform_int_distribution<int>(0, 199);
+    auto weight = std::uniform_int_distribution<int>(0, 50);
+    auto g = graph_type();
+    for (auto i = 0; i < 200; ++i) {
+        g.insert_node(i);
+    }
+    auto batch = g.batch();
+    for (auto i = 0; i < 1000; ++i) {
+        batch.insert_edge(node(engine), node(engine), weight(engine));
+    }
+    batch.commit();
+    auto const version = g.snapshot();
+    auto const& snapshot = *version;
+    auto const expected = total_weight(xtd::kruskal(snapshot));
+    EXPECT_EQ(expected, total_weight(xtd::prim(snapshot)));
+    EXPECT_EQ(expected, total_weight(xtd::boruvka(snapshot)));
+    EXPECT_EQ(xtd::kruskal(snapshot).size(), xtd::boruvka(snapshot).size());
+}
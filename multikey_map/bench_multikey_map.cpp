@@ -0,0 +1,83 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include "concurrent_multikey_map.hpp"
+#include "flat_multikey_map.hpp"
+
+// Throughput of a read-mostly cache workload (90% find, 10% insert_or_assign on a fixed key space)
+// against a flat_multikey_map behind one shared_mutex and against concurrent_multikey_map, from 1 to
+// 64 threads.
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int keySpace = 1 << 16;
+
+// A flat_multikey_map behind one reader-writer lock, with the concurrent_multikey_map interface.
+class Locked {
+public:
+    auto find(int a, int b, int c) const -> std::optional<long> {
+        std::shared_lock lock(mutex);
+        if (auto const* value = map.find(a, b, c)) return *value;
+        return std::nullopt;
+    }
+
+    auto insert_or_assign(int a, int b, int c, long value) -> bool {
+        std::unique_lock lock(mutex);
+        return map.insert_or_assign(a, b, c, value);
+    }
+
+private:
+    mutable std::shared_mutex mutex;
+    xtd::flat_multikey_map<int, int, int, long> map;
+};
+
+// Returns millions of operations per second done by threads threads sharing map.
+template <typename Map>
+auto throughput(Map& map, int threads, int opsPerThread) -> double {
+    std::atomic<int> ready = 0;
+    std::atomic<long> hits = 0;
+    std::vector<std::thread> workers;
+    Clock::time_point start;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937 random(t);
+            if (++ready == threads) start = Clock::now();
+            while (ready < threads) std::this_thread::yield();
+            long found = 0;
+            for (int i = 0; i < opsPerThread; ++i) {
+                auto const key = static_cast<int>(random() % keySpace);
+                if (random() % 10 == 0) {
+                    map.insert_or_assign(key >> 8, key & 0xff, key % 7, i);
+                } else {
+                    found += map.find(key >> 8, key & 0xff, key % 7).has_value();
+                }
+            }
+            hits += found;
+        });
+    }
+    for (auto& w : workers) w.join();
+    return static_cast<double>(threads) * opsPerThread / std::chrono::duration<double>(Clock::now() - start).count() / 1e6;
+}
+
+int main() {
+    constexpr int ops = 1 << 21;
+    std::printf("%8s %16s %16s\n", "threads", "rwlock (M/s)", "sharded (M/s)");
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        auto locked = std::make_unique<Locked>();
+        auto sharded = std::make_unique<xtd::concurrent_multikey_map<int, int, int, long>>();
+        for (int key = 0; key < keySpace; key += 2) {
+            locked->insert_or_assign(key >> 8, key & 0xff, key % 7, key);
+            sharded->insert_or_assign(key >> 8, key & 0xff, key % 7, key);
+        }
+        auto const rwlock = throughput(*locked, threads, ops / threads);
+        auto const concurrent = throughput(*sharded, threads, ops / threads);
+        std::printf("%8d %16.2f %16.2f\n", threads, rwlock, concurrent);
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * concurrent_multikey_map is a flat_multikey_map that many threads can read and update at once. It
+ * is split into shards by the hash of the whole key sequence, each guarded by its own reader-writer
+ * lock.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "flat_multikey_map.hpp"
+
+namespace xtd {
+
+namespace detail {
+
+template <typename KeyTuple, typename T>
+class concurrent_multikey_map;
+
+template <typename... Keys, typename T>
+class concurrent_multikey_map<std::tuple<Keys...>, T> {
+   public:
+    using key_type = std::tuple<Keys...>;
+    using mapped_type = T;
+    using size_type = std::size_t;
+
+    // Four shards per hardware thread, so that threads rarely want the same shard at once.
+    static auto default_shard_count() -> size_type {
+        return std::bit_ceil(std::max<size_type>(16, 4 * std::thread::hardware_concurrency()));
+    }
+
+    // shards is rounded up to a power of two.
+    explicit concurrent_multikey_map(size_type shards = default_shard_count())
+        : shard_bits_(std::countr_zero(std::bit_ceil(std::max<size_type>(1, shards)))),
+          shards_(std::make_unique<shard[]>(shard_count())) {}
+
+    concurrent_multikey_map(concurrent_multikey_map const&) = delete;
+    auto operator=(concurrent_multikey_map const&) -> concurrent_multikey_map& = delete;
+
+    [[nodiscard]] auto shard_count() const noexcept -> size_type {
+        return size_type(1) << shard_bits_;
+    }
+
+    // The number of entries. Shards are counted one at a time, so under concurrent updates this is
+    // only a snapshot of each shard, not of the whole map.
+    [[nodiscard]] auto size() const -> size_type {
+        size_type count = 0;
+        for_each_shard([&](shard const& s) {
+            std::shared_lock lock(s.mutex);
+            count += s.map.size();
+        });
+        return count;
+    }
+
+    [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+    auto clear() -> void {
+        for_each_shard([](shard& s) {
+            std::unique_lock lock(s.mutex);
+            s.map.clear();
+        });
+    }
+
+    // Makes room for about count entries, spread evenly over the shards.
+    auto reserve(size_type count) -> void {
+        auto const per_shard = count / shard_count() + count / shard_count() / 8 + 1;
+        for_each_shard([&](shard& s) {
+            std::unique_lock lock(s.mutex);
+            s.map.reserve(per_shard);
+        });
+    }
+
+    // Returns a copy of the value mapped to keys, or nothing. Never inserts; readers of one shard do
+    // not block each other.
+    auto find(Keys const&... keys) const -> std::optional<T> {
+        auto const& s = shard_of(keys...);
+        std::shared_lock lock(s.mutex);
+        if (auto const* mapped = s.map.find(keys...)) return *mapped;
+        return std::nullopt;
+    }
+
+    [[nodiscard]] auto contains(Keys const&... keys) const -> bool {
+        auto const& s = shard_of(keys...);
+        std::shared_lock lock(s.mutex);
+        return s.map.contains(keys...);
+    }
+
+    // Calls f with the value mapped to keys, under the shard's shared lock, so that part of a large
+    // value can be read without copying it. Returns false if there is no value.
+    template <typename F>
+    auto visit(Keys const&... keys, F&& f) const -> bool {
+        auto const& s = shard_of(keys...);
+        std::shared_lock lock(s.mutex);
+        auto const* mapped = s.map.find(keys...);
+        if (mapped == nullptr) return false;
+        std::forward<F>(f)(*mapped);
+        return true;
+    }
+
+    // Maps keys to value if they are not present. Returns true if value was inserted.
+    auto insert(Keys const&... keys, T value) -> bool {
+        auto& s = shard_of(keys...);
+        std::unique_lock lock(s.mutex);
+        return s.map.try_emplace(keys..., std::move(value)).second;
+    }
+
+    // Maps keys to value. Returns true if keys were not present before.
+    auto insert_or_assign(Keys const&... keys, T value) -> bool {
+        auto& s = shard_of(keys...);
+        std::unique_lock lock(s.mutex);
+        return s.map.insert_or_assign(keys..., std::move(value));
+    }
+
+    // Calls f with the value mapped to keys, under the shard's exclusive lock, so that a
+    // read-modify-write is atomic. Returns false if there is no value.
+    template <typename F>
+    auto update(Keys const&... keys, F&& f) -> bool {
+        auto& s = shard_of(keys...);
+        std::unique_lock lock(s.mutex);
+        auto* mapped = s.map.find(keys...);
+        if (mapped == nullptr) return false;
+        std::forward<F>(f)(*mapped);
+        return true;
+    }
+
+    // Removes the value mapped to keys. Returns false if there was none.
+    auto erase(Keys const&... keys) -> bool {
+        auto& s = shard_of(keys...);
+        std::unique_lock lock(s.mutex);
+        return s.map.erase(keys...);
+    }
+
+   private:
+    static constexpr std::size_t cache_line_size = 64;
+
+    // Each shard is padded to its own cache lines, so that locking one does not invalidate the line
+    // holding its neighbour's lock.
+    struct alignas(cache_line_size) shard {
+        mutable std::shared_mutex mutex;
+        flat_multikey_map<key_type, T> map;
+    };
+
+    // The shard is chosen by the top bits of the hash. flat_multikey_map takes its fingerprint from
+    // the low 7 bits and its probe group from the bits above them, which hash_keys mixes
+    // independently of the top ones, so the keys within one shard still spread over its whole table.
+    auto shard_of(Keys const&... keys) const -> shard& {
+        return shards_[std::rotl(hash_keys(keys...), shard_bits_) & (shard_count() - 1)];
+    }
+
+    template <typename F>
+    auto for_each_shard(F f) const -> void {
+        for (size_type i = 0; i < shard_count(); ++i) f(shards_[i]);
+    }
+
+    template <typename F>
+    auto for_each_shard(F f) -> void {
+        for (size_type i = 0; i < shard_count(); ++i) f(shards_[i]);
+    }
+
+    int shard_bits_;
+    std::unique_ptr<shard[]> shards_;
+};
+
+}  // namespace detail
+
+// concurrent_multikey_map<K1, ..., Kn, V> maps each key sequence (k1, ..., kn) to a V, and is safe
+// to use from any number of threads.
+//
+// Values are only handed out by copy (find) or inside a callback that holds the shard's lock (visit,
+// update), since another thread may move or erase them at any time.
+template <typename... Args>
+using concurrent_multikey_map =
+    detail::concurrent_multikey_map<typename detail::split_mapped<Args...>::key_type,
+                                    typename detail::split_mapped<Args...>::mapped_type>;
+
+}  // namespace xtd
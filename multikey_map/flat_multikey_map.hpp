@@ -0,0 +1,543 @@
+/**
+ * flat_multikey_map is a multikey_map stored in a single flat open-addressing hash table keyed on
+ * the whole key tuple, instead of one nested unordered_map per key.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "multikey_map.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace xtd {
+
+// Stands for any key in a partial-key query, as in map.find(a, _, c): MATLAB's : operator.
+struct wildcard {
+    explicit wildcard() = default;
+};
+
+inline constexpr wildcard _{};
+
+namespace detail {
+
+// Splits Args... into the tuple of all but the last type, and the last type.
+template <typename... Args>
+struct split_mapped {
+    static_assert(sizeof...(Args) >= 2, "a multikey map needs at least one key and a mapped type");
+
+    template <std::size_t... I>
+    static auto keys(std::index_sequence<I...>) -> std::tuple<std::tuple_element_t<I, std::tuple<Args...>>...>;
+
+    using key_type = decltype(keys(std::make_index_sequence<sizeof...(Args) - 1>()));
+    using mapped_type = std::tuple_element_t<sizeof...(Args) - 1, std::tuple<Args...>>;
+};
+
+// Combines the std::hash of every key, then finalises the result with MurmurHash3's fmix64 so that
+// every output bit depends on every input bit. std::hash is the identity for integers, and a multiply
+// alone only carries entropy upwards: keys differing only in their high bits would then share the
+// low bits that select the probe group and the fingerprint.
+template <typename... Keys>
+auto hash_keys(Keys const&... keys) -> std::size_t {
+    std::uint64_t seed = 0;
+    ((seed ^= std::hash<Keys>()(keys) + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2)), ...);
+    seed ^= seed >> 33;
+    seed *= 0xff51afd7ed558ccd;
+    seed ^= seed >> 33;
+    seed *= 0xc4ceb9fe1a85ec53;
+    seed ^= seed >> 33;
+    return static_cast<std::size_t>(seed);
+}
+
+// Secondary index of the entries of a flat_multikey_map by the key at one position.
+template <typename Key>
+struct key_index {
+    // Indices of the entries with each key at this position, in no particular order.
+    std::unordered_map<Key, std::vector<std::uint32_t>> postings;
+    // Where each entry sits in its posting list, so that unlinking it is O(1).
+    std::vector<std::uint32_t> positions;
+};
+
+template <typename KeyTuple, typename T>
+class flat_multikey_map;
+
+template <typename... Keys, typename T>
+class flat_multikey_map<std::tuple<Keys...>, T> {
+    template <bool Const>
+    class iterator_base;
+
+   public:
+    using key_type = std::tuple<Keys...>;
+    using mapped_type = T;
+    using value_type = std::tuple<Keys..., T>;  // A key sequence followed by its value.
+    using size_type = std::size_t;
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+    using reference = std::tuple<Keys const&..., T&>;
+    using const_reference = std::tuple<Keys const&..., T const&>;
+
+    flat_multikey_map() = default;
+
+    explicit flat_multikey_map(size_type count) { reserve(count); }
+
+    flat_multikey_map(std::initializer_list<value_type> ilist) { insert(ilist.begin(), ilist.end()); }
+
+    template <iterator_of_category<std::input_iterator_tag> InputIt>
+    flat_multikey_map(InputIt first, InputIt last) {
+        insert(first, last);
+    }
+
+    // Every (k1, ..., kn, value) in the map, as a tuple of references, in insertion order until the
+    // first erasure.
+    auto begin() noexcept -> iterator { return iterator(entries_.data()); }
+    auto end() noexcept -> iterator { return iterator(entries_.data() + entries_.size()); }
+    auto begin() const noexcept -> const_iterator { return const_iterator(entries_.data()); }
+    auto end() const noexcept -> const_iterator { return const_iterator(entries_.data() + entries_.size()); }
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return entries_.empty(); }
+    [[nodiscard]] auto size() const noexcept -> size_type { return entries_.size(); }
+
+    // Number of slots in the table; the table is rehashed before it is 7/8 full.
+    [[nodiscard]] auto bucket_count() const noexcept -> size_type { return controls_.size(); }
+
+    auto clear() noexcept -> void {
+        entries_.clear();
+        controls_.clear();
+        slots_.clear();
+        tombstones_ = 0;
+        for_each_index([this](auto i) {
+            std::get<i>(indexes_)->postings.clear();
+            std::get<i>(indexes_)->positions.clear();
+        });
+    }
+
+    // Makes room for count entries without rehashing.
+    auto reserve(size_type count) -> void {
+        entries_.reserve(count);
+        if (count + tombstones_ > max_load(bucket_count())) rehash(std::max(count, size()));
+    }
+
+    // Returns the value mapped to keys, default constructing it first if there is none.
+    auto operator()(Keys const&... keys) -> T& { return try_emplace(keys...).first; }
+
+    // Returns a pointer to the value mapped to keys, or nullptr if there is none. Never inserts.
+    auto find(Keys const&... keys) -> T* {
+        auto const slot = find_slot(hash_keys(keys...), keys...);
+        return slot == npos ? nullptr : &entries_[slots_[slot]].second;
+    }
+
+    auto find(Keys const&... keys) const -> T const* {
+        auto const slot = find_slot(hash_keys(keys...), keys...);
+        return slot == npos ? nullptr : &entries_[slots_[slot]].second;
+    }
+
+    [[nodiscard]] auto contains(Keys const&... keys) const -> bool { return find(keys...) != nullptr; }
+
+    // Returns the value mapped to keys, and whether it was inserted rather than already present. A
+    // new value is constructed from args, which are left untouched if keys are already present.
+    template <typename... Args>
+    auto try_emplace(Keys const&... keys, Args&&... args) -> std::pair<T&, bool> {
+        auto const hash = hash_keys(keys...);
+        if (auto const slot = find_slot(hash, keys...); slot != npos) return {entries_[slots_[slot]].second, false};
+        auto& inserted = append(hash, std::forward_as_tuple(keys...), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {inserted.second, true};
+    }
+
+    // Maps keys to value. Returns true if keys were not present before.
+    auto insert_or_assign(Keys const&... keys, T value) -> bool {
+        auto const hash = hash_keys(keys...);
+        if (auto const slot = find_slot(hash, keys...); slot != npos) {
+            entries_[slots_[slot]].second = std::move(value);
+            return false;
+        }
+        append(hash, std::forward_as_tuple(keys...), std::forward_as_tuple(std::move(value)));
+        return true;
+    }
+
+    // Maps (k1, ..., kn) to value for a row (k1, ..., kn, value), unless the key sequence is already
+    // present. Returns true if the row was inserted.
+    auto insert(value_type const& row) -> bool {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+            auto const hash = hash_keys(std::get<I>(row)...);
+            if (find_slot(hash, std::get<I>(row)...) != npos) return false;
+            append(hash, std::forward_as_tuple(std::get<I>(row)...), std::forward_as_tuple(std::get<sizeof...(Keys)>(row)));
+            return true;
+        }(std::index_sequence_for<Keys...>());
+    }
+
+    // Inserts every row of [first, last), as insert(row) does. The table is grown once up front when
+    // the rows can be counted.
+    template <iterator_of_category<std::input_iterator_tag> InputIt>
+    auto insert(InputIt first, InputIt last) -> void {
+        if constexpr (iterator_of_category<InputIt, std::forward_iterator_tag>) {
+            reserve(size() + static_cast<size_type>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) insert(*first);
+    }
+
+    auto insert(std::initializer_list<value_type> ilist) -> void { insert(ilist.begin(), ilist.end()); }
+
+    // Removes the value mapped to keys. Returns false if there was none.
+    auto erase(Keys const&... keys) -> bool {
+        auto const slot = find_slot(hash_keys(keys...), keys...);
+        if (slot == npos) return false;
+        erase_slot(slot);
+        return true;
+    }
+
+    // Returns the entries whose keys equal pattern at every position that is not the wildcard _.
+    // The search starts from the shortest posting list of the indexed positions that pattern fixes,
+    // so it takes time proportional to that list rather than to size(). With no such position, every
+    // entry is scanned.
+    template <typename... Pattern>
+        requires(sizeof...(Pattern) == sizeof...(Keys) && (std::is_same_v<Pattern, wildcard> || ...) &&
+                 ((std::is_same_v<Pattern, wildcard> || std::is_convertible_v<Pattern const&, Keys>) && ...))
+    auto find(Pattern const&... pattern) -> std::vector<std::pair<key_type const&, T&>> {
+        std::vector<std::pair<key_type const&, T&>> found;
+        for_each_match([&](size_type i) { found.emplace_back(entries_[i].first, entries_[i].second); }, pattern...);
+        return found;
+    }
+
+    template <typename... Pattern>
+        requires(sizeof...(Pattern) == sizeof...(Keys) && (std::is_same_v<Pattern, wildcard> || ...) &&
+                 ((std::is_same_v<Pattern, wildcard> || std::is_convertible_v<Pattern const&, Keys>) && ...))
+    auto find(Pattern const&... pattern) const -> std::vector<std::pair<key_type const&, T const&>> {
+        std::vector<std::pair<key_type const&, T const&>> found;
+        for_each_match([&](size_type i) { found.emplace_back(entries_[i].first, entries_[i].second); }, pattern...);
+        return found;
+    }
+
+    // Maintains a secondary index of the entries by their Ith key, for find with wildcards. Each index
+    // costs a hash table node per distinct key and two 32 bit indices per entry, and is updated on
+    // every insertion and erasure.
+    template <std::size_t I>
+    auto add_index() -> void {
+        auto& index = std::get<I>(indexes_);
+        if (index) return;
+        index.emplace();
+        index->positions.reserve(entries_.capacity());
+        for (size_type i = 0; i < entries_.size(); ++i) link<I>(i);
+    }
+
+    template <std::size_t I>
+    auto drop_index() -> void {
+        std::get<I>(indexes_).reset();
+    }
+
+    template <std::size_t I>
+    [[nodiscard]] auto has_index() const noexcept -> bool {
+        return std::get<I>(indexes_).has_value();
+    }
+
+    // Returns the value mapped to keys, or throws std::out_of_range if there is none.
+    auto at(Keys const&... keys) -> T& {
+        if (auto* mapped = find(keys...)) return *mapped;
+        throw std::out_of_range("flat_multikey_map::at");
+    }
+
+    auto at(Keys const&... keys) const -> T const& {
+        if (auto const* mapped = find(keys...)) return *mapped;
+        throw std::out_of_range("flat_multikey_map::at");
+    }
+
+   private:
+    // Entries live densely in insertion order, with erasure moving the last entry into the gap. The
+    // table itself only holds a control byte and a 32 bit entry index per slot.
+    using entry = std::pair<key_type, T>;
+    using control = std::int8_t;
+
+    // A control byte is empty, deleted (a tombstone, so probes continue past it) or, when
+    // non-negative, the low 7 bits of the hash of the entry in that slot.
+    static constexpr control empty_control = -128;
+    static constexpr control deleted_control = -2;
+    static constexpr size_type group_width = 16;
+    static constexpr size_type npos = ~size_type(0);
+
+    using indexes = std::tuple<std::optional<key_index<Keys>>...>;
+
+    static auto max_load(size_type buckets) -> size_type { return buckets - buckets / 8; }
+    static auto fingerprint(std::size_t hash) -> control { return static_cast<control>(hash & 0x7f); }
+
+    // Bit i of the result is set if control byte i of the group starting at first matches.
+    static auto match(control const* first, control value) -> std::uint32_t {
+#if defined(__SSE2__)
+        auto const group = _mm_loadu_si128(reinterpret_cast<__m128i const*>(first));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value))));
+#else
+        std::uint32_t mask = 0;
+        for (size_type i = 0; i < group_width; ++i) mask |= std::uint32_t(first[i] == value) << i;
+        return mask;
+#endif
+    }
+
+    // As match, for the empty and deleted bytes, which are the negative ones.
+    static auto match_free(control const* first) -> std::uint32_t {
+#if defined(__SSE2__)
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(first))));
+#else
+        std::uint32_t mask = 0;
+        for (size_type i = 0; i < group_width; ++i) mask |= std::uint32_t(first[i] < 0) << i;
+        return mask;
+#endif
+    }
+
+    // Visits the groups of 16 slots in the order hash probes them, until visit returns true. The
+    // group count is a power of two, so triangular steps visit every group once. The group comes from
+    // the bits just above the 7 bit fingerprint; concurrent_multikey_map picks shards from the top
+    // bits, so the two stay independent.
+    template <typename Visit>
+    auto probe(std::size_t hash, Visit visit) const -> void {
+        auto const mask = bucket_count() / group_width - 1;
+        auto group = (hash >> 7) & mask;
+        for (size_type step = 1; !visit(group * group_width); ++step) group = (group + step) & mask;
+    }
+
+    auto find_slot(std::size_t hash, Keys const&... keys) const -> size_type {
+        if (entries_.empty()) return npos;
+        auto found = npos;
+        probe(hash, [&](size_type first) {
+            for (auto matches = match(&controls_[first], fingerprint(hash)); matches != 0; matches &= matches - 1) {
+                auto const slot = first + std::countr_zero(matches);
+                if (std::get<0>(entries_[slots_[slot]]) == std::tie(keys...)) {
+                    found = slot;
+                    return true;
+                }
+            }
+            // A group with an empty slot ends the probe sequence: the key would have been put there.
+            return match(&controls_[first], empty_control) != 0;
+        });
+        return found;
+    }
+
+    // Points the first free slot in hash's probe sequence at entries_[index].
+    auto claim_slot(std::size_t hash, size_type index) -> void {
+        probe(hash, [&](size_type first) {
+            auto const free = match_free(&controls_[first]);
+            if (free == 0) return false;
+            auto const slot = first + std::countr_zero(free);
+            tombstones_ -= controls_[slot] == deleted_control;
+            controls_[slot] = fingerprint(hash);
+            slots_[slot] = static_cast<std::uint32_t>(index);
+            return true;
+        });
+    }
+
+    // Adds an entry for keys that are not present, growing the table geometrically if it is full.
+    template <typename KeyArgs, typename MappedArgs>
+    auto append(std::size_t hash, KeyArgs&& keys, MappedArgs&& mapped) -> entry& {
+        if (entries_.size() + tombstones_ + 1 > max_load(bucket_count())) {
+            rehash(std::max<size_type>(entries_.size() + 1, 2 * entries_.size()));
+        }
+        entries_.emplace_back(std::piecewise_construct, std::forward<KeyArgs>(keys), std::forward<MappedArgs>(mapped));
+        claim_slot(hash, entries_.size() - 1);
+        for_each_index([this](auto i) { link<i>(entries_.size() - 1); });
+        return entries_.back();
+    }
+
+    auto erase_slot(size_type slot) -> void {
+        auto const index = slots_[slot];
+        controls_[slot] = deleted_control;
+        ++tombstones_;
+
+        // Keep entries_ dense by moving the last entry into the gap and repointing its slot.
+        auto const last = entries_.size() - 1;
+        for_each_index([&](auto i) { unlink<i>(index, last); });
+        if (index != last) {
+            auto const moved = std::apply([this](auto const&... keys) { return find_slot(hash_keys(keys...), keys...); },
+                                          entries_[last].first);
+            entries_[index] = std::move(entries_[last]);
+            slots_[moved] = index;
+        }
+        entries_.pop_back();
+    }
+
+    // Rebuilds the table with room for at least count entries, dropping every tombstone.
+    auto rehash(size_type count) -> void {
+        if (count > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("flat_multikey_map too large");
+        auto buckets = std::bit_ceil(std::max(group_width, count + count / 7 + 1));
+        if (max_load(buckets) < count) buckets *= 2;
+        controls_.assign(buckets, empty_control);
+        slots_.assign(buckets, 0);
+        tombstones_ = 0;
+        for (size_type i = 0; i < entries_.size(); ++i) {
+            claim_slot(std::apply([](auto const&... keys) { return hash_keys(keys...); }, entries_[i].first), i);
+        }
+    }
+
+    // Calls visit with std::integral_constant<std::size_t, I> for every indexed position I.
+    template <typename Visit>
+    auto for_each_index(Visit visit) -> void {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((std::get<I>(indexes_) ? visit(std::integral_constant<std::size_t, I>()) : void()), ...);
+        }(std::index_sequence_for<Keys...>());
+    }
+
+    // Adds entries_[entry], which must be the last entry the index has seen, to index I.
+    template <std::size_t I>
+    auto link(size_type entry) -> void {
+        auto& index = *std::get<I>(indexes_);
+        auto& list = index.postings[std::get<I>(entries_[entry].first)];
+        index.positions.push_back(static_cast<std::uint32_t>(list.size()));
+        list.push_back(static_cast<std::uint32_t>(entry));
+    }
+
+    // Removes entries_[entry] from index I, then renumbers entries_[last] as entry, to match the
+    // move erase_slot is about to make.
+    template <std::size_t I>
+    auto unlink(size_type entry, size_type last) -> void {
+        auto& index = *std::get<I>(indexes_);
+        auto const list = index.postings.find(std::get<I>(entries_[entry].first));
+        auto const moved = list->second.back();
+        list->second[index.positions[entry]] = moved;
+        index.positions[moved] = index.positions[entry];
+        list->second.pop_back();
+        if (list->second.empty()) index.postings.erase(list);
+
+        if (entry != last) {
+            index.positions[entry] = index.positions[last];
+            index.postings.find(std::get<I>(entries_[last].first))->second[index.positions[entry]] =
+                static_cast<std::uint32_t>(entry);
+        }
+        index.positions.pop_back();
+    }
+
+    // Narrows candidates to the posting list of pattern in index I, if it is shorter. Sets none if
+    // no entry has pattern as its Ith key.
+    template <std::size_t I, typename Pattern>
+    auto narrow(Pattern const& pattern, std::vector<std::uint32_t> const*& candidates, bool& none) const -> void {
+        if constexpr (!std::is_same_v<Pattern, wildcard>) {
+            auto const& index = std::get<I>(indexes_);
+            if (!index) return;
+            auto const list = index->postings.find(std::tuple_element_t<I, key_type>(pattern));
+            if (list == index->postings.end()) {
+                none = true;
+            } else if (candidates == nullptr || list->second.size() < candidates->size()) {
+                candidates = &list->second;
+            }
+        }
+    }
+
+    template <typename Key, typename Pattern>
+    static auto key_matches(Key const& key, Pattern const& pattern) -> bool {
+        if constexpr (std::is_same_v<Pattern, wildcard>) {
+            return true;
+        } else {
+            return key == pattern;
+        }
+    }
+
+    // Calls visit with the index of every entry matching pattern.
+    template <typename Visit, typename... Pattern>
+    auto for_each_match(Visit visit, Pattern const&... pattern) const -> void {
+        auto const matches = [&](key_type const& keys) {
+            return [&]<std::size_t... I>(std::index_sequence<I...>) {
+                return (key_matches(std::get<I>(keys), pattern) && ...);
+            }(std::index_sequence_for<Keys...>());
+        };
+
+        std::vector<std::uint32_t> const* candidates = nullptr;
+        bool none = false;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (narrow<I>(pattern, candidates, none), ...);
+        }(std::index_sequence_for<Keys...>());
+        if (none) return;
+
+        if (candidates != nullptr) {
+            for (auto const i : *candidates) {
+                if (matches(entries_[i].first)) visit(i);
+            }
+        } else {
+            for (size_type i = 0; i < entries_.size(); ++i) {
+                if (matches(entries_[i].first)) visit(i);
+            }
+        }
+    }
+
+    std::vector<entry> entries_;
+    std::vector<control> controls_;
+    std::vector<std::uint32_t> slots_;
+    size_type tombstones_ = 0;
+    indexes indexes_;
+};
+
+// Iterates the dense entry array, yielding (k1, ..., kn, value) tuples of references.
+template <typename... Keys, typename T>
+template <bool Const>
+class flat_multikey_map<std::tuple<Keys...>, T>::iterator_base {
+    using entry_pointer = std::conditional_t<Const, entry const*, entry*>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = flat_multikey_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::conditional_t<Const, const_reference, flat_multikey_map::reference>;
+
+    iterator_base() = default;
+
+    // An iterator converts to a const_iterator.
+    template <bool OtherConst>
+        requires(Const && !OtherConst)
+    iterator_base(iterator_base<OtherConst> const& other) : entry_(other.entry_) {}
+
+    auto operator*() const -> reference {
+        return std::apply([this](auto const&... keys) { return reference(keys..., entry_->second); }, entry_->first);
+    }
+
+    auto operator++() -> iterator_base& {
+        ++entry_;
+        return *this;
+    }
+
+    auto operator++(int) -> iterator_base {
+        auto old = *this;
+        ++entry_;
+        return old;
+    }
+
+    friend auto operator==(iterator_base const& a, iterator_base const& b) -> bool = default;
+
+   private:
+    friend class flat_multikey_map;
+    friend class iterator_base<!Const>;
+
+    explicit iterator_base(entry_pointer entry) : entry_(entry) {}
+
+    entry_pointer entry_ = nullptr;
+};
+
+}  // namespace detail
+
+// flat_multikey_map<K1, ..., Kn, V> maps each key sequence (k1, ..., kn) to a V, like
+// multikey_map, but looks a key sequence up with one combined hash and one probe sequence.
+//
+// The table is Swiss-table style: slots are probed a group of 16 at a time, comparing a 7 bit
+// fingerprint of the hash for all 16 at once (with SSE2 where available), and keys are only
+// compared on a fingerprint match. Values are stored densely rather than in per-key nodes, so, as
+// with std::vector, inserting or erasing invalidates references to values.
+//
+// find also takes partial keys, with the wildcard _ at the positions that may hold any key, and
+// add_index<I>() keeps a secondary index by the Ith key to answer those without a full scan.
+template <typename... Args>
+using flat_multikey_map = detail::flat_multikey_map<typename detail::split_mapped<Args...>::key_type,
+                                                    typename detail::split_mapped<Args...>::mapped_type>;
+
+}  // namespace xtd
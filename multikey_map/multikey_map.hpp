@@ -5,19 +5,27 @@
 
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <tuple>
 #include <type_traits>
 #include <unordered_map>
-
-// Because no compiler supports std::type_identity yet...
-namespace std {
-template <typename T>
-struct type_identity {
-    using type = T;
-};
-}  // namespace std
+#include <utility>
 
 namespace xtd {
 
+namespace detail {
+
+// Iterators whose iterator_category is at least Tag. Unlike the C++20 iterator concepts, this admits
+// proxy iterators whose reference and value_type have no common reference, such as these maps' own.
+template <typename It, typename Tag>
+concept iterator_of_category = std::derived_from<typename std::iterator_traits<It>::iterator_category, Tag>;
+
+}  // namespace detail
+
 template <typename... Args>
 class multikey_map {
    private:
@@ -30,6 +38,7 @@ class multikey_map {
     template <typename Key, typename T>
     struct multikey_map_imple<Key, T> {
         using type = typename std::unordered_map<Key, T>;
+        using keys = std::tuple<Key>;
     };
 
     template <typename Key, typename... Tn>
@@ -37,15 +46,33 @@ class multikey_map {
         // Inner multikey_map_imple needs to have keywords typename and ::type to get base case's type or
         // type is overriden as just multikey_map_imple<2nd last arg, last arg>.
         using type = typename std::unordered_map<Key, typename multikey_map_imple<Tn...>::type>;
+        using keys = decltype(std::tuple_cat(std::tuple<Key>(), typename multikey_map_imple<Tn...>::keys()));
+    };
+
+    // The map type of the level holding the Lth key.
+    template <std::size_t L, typename Map>
+    struct level_of {
+        using type = typename level_of<L - 1, typename Map::mapped_type>::type;
+    };
+
+    template <typename Map>
+    struct level_of<0, Map> {
+        using type = Map;
     };
 
     typename multikey_map_imple<Args...>::type map_;  // This map is where the magic happens.
 
+    static constexpr std::size_t depth = sizeof...(Args) - 1;  // Number of keys.
+
+    template <std::size_t L>
+    using level = typename level_of<L, decltype(map_)>::type;
+
+    template <bool Const>
+    class iterator_base;
+
    public:
-    using key_type = std::tuple<const Args...>;
-    using value_type = std::tuple<const Args...>;
-    using reference = value_type&;
-    using const_reference = const value_type&;
+    using key_type = typename multikey_map_imple<Args...>::keys;
+    using value_type = std::tuple<Args...>;  // A key sequence followed by its value.
 
     // Uses fold expression (, ...) to unpack Args then decltype inspects value category
     // of the unpacked "comma expression" which is basically the last arg. Good to note that mapped_type
@@ -53,17 +80,27 @@ class multikey_map {
     using mapped_type = typename decltype((std::type_identity<Args>{}, ...))::type;
     using null = struct null;
 
-    // class iterator {
-    //     std::unordered_map<last_key, mapped_type>::iterator current;
-    // };
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+    using reference = typename iterator::reference;
+    using const_reference = typename const_iterator::reference;
 
     multikey_map() = default;
 
-    // multikey_map(std::initializer_list<value_type> ilist) : map_(ilist) {}
+    multikey_map(std::initializer_list<value_type> ilist) {
+        insert(ilist.begin(), ilist.end());
+    }
+
+    template <detail::iterator_of_category<std::input_iterator_tag> InputIt>
+    multikey_map(InputIt first, InputIt last) {
+        insert(first, last);
+    }
 
-    // auto operator=(std::initilizer_list<value_type> ilist) {
-    //     map_ = ilist;
-    // }
+    auto operator=(std::initializer_list<value_type> ilist) -> multikey_map& {
+        clear();
+        insert(ilist.begin(), ilist.end());
+        return *this;
+    }
 
     multikey_map(multikey_map const& other) : map_(other.map_) {}
 
@@ -90,10 +127,96 @@ class multikey_map {
         return map_.empty();
     }
 
+    // The number of keys in the top level, not the number of values: {1, 2, v} and {1, 3, w} count
+    // once. Inner maps are handed out by operator[], so the values are not counted as they change;
+    // std::distance(begin(), end()) counts them.
     [[nodiscard]] auto size() const noexcept -> std::size_t {
         return map_.size();
     }
 
+    // Approximate bytes allocated by the map: every level's bucket array, plus a node per element
+    // holding a next pointer and the element. Memory owned by the keys and values themselves, such
+    // as a std::string's buffer, is not counted.
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+        return sizeof(*this) + level_usage<0>(map_);
+    }
+
+    // Removes every inner map that is empty, such as those operator[] creates when looking up absent
+    // keys, then shrinks each level's bucket array to fit what is left. Returns the number of inner
+    // maps removed. Invalidates iterators.
+    auto compact() -> std::size_t {
+        return compact_level<0>(map_);
+    }
+
+    // Returns a pointer to the value mapped to keys, or nullptr if there is none. Unlike operator[],
+    // never creates an inner map.
+    template <typename... Keys>
+        requires(sizeof...(Keys) == depth)
+    auto find(Keys const&... keys) -> mapped_type* {
+        return find_in<mapped_type>(map_, keys...);
+    }
+
+    template <typename... Keys>
+        requires(sizeof...(Keys) == depth)
+    auto find(Keys const&... keys) const -> mapped_type const* {
+        return find_in<mapped_type const>(map_, keys...);
+    }
+
+    template <typename... Keys>
+        requires(sizeof...(Keys) == depth)
+    [[nodiscard]] auto contains(Keys const&... keys) const -> bool {
+        return find(keys...) != nullptr;
+    }
+
+    // Removes the value mapped to keys, along with any inner map that this leaves empty. Returns false
+    // if there was no value.
+    template <typename... Keys>
+        requires(sizeof...(Keys) == depth)
+    auto erase(Keys const&... keys) -> bool {
+        return erase_in(map_, keys...);
+    }
+
+    // Every (k1, ..., kn, value) in the map, as a tuple of references. Each level is visited in its
+    // unordered_map's order, so the key sequences come out grouped by their prefixes.
+    auto begin() -> iterator {
+        return iterator(map_, map_.begin());
+    }
+
+    auto end() -> iterator {
+        return iterator(map_, map_.end());
+    }
+
+    auto begin() const -> const_iterator {
+        return const_iterator(map_, map_.begin());
+    }
+
+    auto end() const -> const_iterator {
+        return const_iterator(map_, map_.end());
+    }
+
+    // Maps (k1, ..., kn) to value for a row (k1, ..., kn, value), unless the key sequence is already
+    // present. Returns true if the row was inserted.
+    auto insert(value_type const& row) -> bool {
+        return insert_row<0>(map_, row);
+    }
+
+    // Inserts every row of [first, last), as insert(row) does, by walking each level once per run of
+    // rows that share a key rather than once per row. A level that starts out empty is reserved for its
+    // number of runs, so when the rows are grouped by key prefix, as iteration produces them, every
+    // inner map is allocated at its final size.
+    template <detail::iterator_of_category<std::input_iterator_tag> InputIt>
+    auto insert(InputIt first, InputIt last) -> void {
+        if constexpr (detail::iterator_of_category<InputIt, std::forward_iterator_tag>) {
+            insert_runs<0>(map_, first, last);
+        } else {
+            for (; first != last; ++first) insert(*first);
+        }
+    }
+
+    auto insert(std::initializer_list<value_type> ilist) -> void {
+        insert(ilist.begin(), ilist.end());
+    }
+
     template <typename T>
     auto operator[](T const& index) -> decltype(map_[index])& {
         return map_[index];
@@ -104,22 +227,216 @@ class multikey_map {
         return map_[index];
     }
 
-    // As close as we can get to MATLAB's : operator.
-    // Null type means we don't care about this index i.e. search all values from
-    // Lets us branch in our search
-    // auto operator[](null const& n) -> decltype(map_)& {
-    //     return map_.va;
-    // }
-
-    // auto operator[](null const& n) const -> decltype(map_) {
-    //     return map_[index];
-    // }
+    // MATLAB's : operator, i.e. "any key at this position", would have to search every nested map
+    // here. flat_multikey_map::find takes the wildcard xtd::_ instead, and can answer partial-key
+    // queries from per-position indexes.
 
    private:
     auto swap(multikey_map& other) noexcept -> multikey_map& {
         map_.swap(other.map_);
         return *this;
     }
+
+    template <typename Result, typename Map, typename Key, typename... Rest>
+    static auto find_in(Map& map, Key const& key, Rest const&... rest) -> Result* {
+        auto const it = map.find(key);
+        if (it == map.end()) return nullptr;
+        if constexpr (sizeof...(Rest) == 0) {
+            return &it->second;
+        } else {
+            return find_in<Result>(it->second, rest...);
+        }
+    }
+
+    template <typename Map, typename Key, typename... Rest>
+    static auto erase_in(Map& map, Key const& key, Rest const&... rest) -> bool {
+        if constexpr (sizeof...(Rest) == 0) {
+            return map.erase(key) == 1;
+        } else {
+            auto const it = map.find(key);
+            if (it == map.end() || !erase_in(it->second, rest...)) return false;
+            if (it->second.empty()) map.erase(it);
+            return true;
+        }
+    }
+
+    template <std::size_t L, typename Map>
+    static auto level_usage(Map const& map) noexcept -> std::size_t {
+        auto bytes = map.bucket_count() * sizeof(void*) + map.size() * (sizeof(void*) + sizeof(typename Map::value_type));
+        if constexpr (L + 1 < depth) {
+            for (auto const& [key, inner] : map) bytes += level_usage<L + 1>(inner);
+        }
+        return bytes;
+    }
+
+    template <std::size_t L, typename Map>
+    static auto compact_level(Map& map) -> std::size_t {
+        std::size_t removed = 0;
+        if constexpr (L + 1 < depth) {
+            for (auto it = map.begin(); it != map.end();) {
+                removed += compact_level<L + 1>(it->second);
+                if (it->second.empty()) {
+                    it = map.erase(it);
+                    ++removed;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        map.rehash(0);  // The smallest bucket count that keeps the load factor within its maximum.
+        return removed;
+    }
+
+    template <std::size_t L, typename Map, typename Row>
+    static auto insert_row(Map& map, Row const& row) -> bool {
+        if constexpr (L + 1 == depth) {
+            return map.try_emplace(std::get<L>(row), std::get<L + 1>(row)).second;
+        } else {
+            return insert_row<L + 1>(map.try_emplace(std::get<L>(row)).first->second, row);
+        }
+    }
+
+    // Inserts [first, last), whose rows all share their first L keys, into map, the level holding
+    // the Lth key.
+    template <std::size_t L, typename Map, typename It>
+    static auto insert_runs(Map& map, It first, It last) -> void {
+        auto const next_run = [last](It run) {
+            return std::find_if(std::next(run), last,
+                                [&](auto const& row) { return !(std::get<L>(row) == std::get<L>(*run)); });
+        };
+
+        // Only a map that starts out empty is reserved, and only for its runs. When the rows are not
+        // grouped the runs overcount its keys, so any buckets left spare afterwards are given back.
+        // Reserving a map that already holds keys, such as an inner map met again by an ungrouped
+        // row, would rehash it once per run.
+        std::size_t runs = 0;
+        bool const fresh = map.empty();
+        if (fresh) {
+            for (auto run = first; run != last; run = next_run(run)) ++runs;
+            map.reserve(runs);
+        }
+
+        for (auto run = first; run != last;) {
+            auto const run_end = next_run(run);
+            if constexpr (L + 1 == depth) {
+                // Later rows in the run repeat this key sequence, so they are not inserted.
+                map.try_emplace(std::get<L>(*run), std::get<L + 1>(*run));
+            } else {
+                insert_runs<L + 1>(map.try_emplace(std::get<L>(*run)).first->second, run, run_end);
+            }
+            run = run_end;
+        }
+        if (fresh && map.size() < runs) map.rehash(0);
+    }
+};
+
+// Forward iterator over the values of every level, yielding (k1, ..., kn, value) tuples of
+// references. It keeps one iterator per level and only ever stops at a value, skipping any inner
+// map that has been left empty.
+template <typename... Args>
+template <bool Const>
+class multikey_map<Args...>::iterator_base {
+    template <typename U>
+    using maybe_const = std::conditional_t<Const, U const, U>;
+
+    template <std::size_t L>
+    using level_iterator = decltype(std::declval<maybe_const<level<L>>&>().begin());
+
+    template <std::size_t... L>
+    static auto iterators_of(std::index_sequence<L...>) -> std::tuple<level_iterator<L>...>;
+
+    template <std::size_t... L>
+    static auto reference_of(std::index_sequence<L...>)
+        -> std::tuple<std::tuple_element_t<L, key_type> const&..., maybe_const<mapped_type>&>;
+
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = multikey_map::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = decltype(reference_of(std::make_index_sequence<depth>()));
+
+    iterator_base() = default;
+
+    // An iterator converts to a const_iterator.
+    template <bool OtherConst>
+        requires(Const && !OtherConst)
+    iterator_base(iterator_base<OtherConst> const& other) : root_(other.root_), its_(other.its_) {}
+
+    auto operator*() const -> reference {
+        return [this]<std::size_t... L>(std::index_sequence<L...>) {
+            return reference(std::get<L>(its_)->first..., std::get<depth - 1>(its_)->second);
+        }(std::make_index_sequence<depth>());
+    }
+
+    auto operator++() -> iterator_base& {
+        increment<depth - 1>();
+        return *this;
+    }
+
+    auto operator++(int) -> iterator_base {
+        auto old = *this;
+        ++*this;
+        return old;
+    }
+
+    friend auto operator==(iterator_base const& a, iterator_base const& b) -> bool {
+        return a.template equal<0>(b);
+    }
+
+   private:
+    friend class multikey_map;
+    friend class iterator_base<!Const>;
+
+    // Points at the first value at or after first, a position in the top level map.
+    iterator_base(maybe_const<level<0>>& map, level_iterator<0> first) : root_(&map) {
+        std::get<0>(its_) = first;
+        settle<0>();
+    }
+
+    template <std::size_t L>
+    auto end_of() const -> level_iterator<L> {
+        if constexpr (L == 0) {
+            return root_->end();
+        } else {
+            return std::get<L - 1>(its_)->second.end();
+        }
+    }
+
+    // Moves the iterators of levels L and below to the first value at or after the current position
+    // of level L. Returns false if level L runs out first.
+    template <std::size_t L>
+    auto settle() -> bool {
+        for (; std::get<L>(its_) != end_of<L>(); ++std::get<L>(its_)) {
+            if constexpr (L + 1 == depth) {
+                return true;
+            } else {
+                std::get<L + 1>(its_) = std::get<L>(its_)->second.begin();
+                if (settle<L + 1>()) return true;
+            }
+        }
+        return false;
+    }
+
+    template <std::size_t L>
+    auto increment() -> void {
+        ++std::get<L>(its_);
+        if (settle<L>()) return;
+        if constexpr (L > 0) increment<L - 1>();
+    }
+
+    // Levels below one that is at its end hold stale iterators, so they are not compared.
+    template <std::size_t L>
+    auto equal(iterator_base const& other) const -> bool {
+        if (std::get<L>(its_) != std::get<L>(other.its_)) return false;
+        if constexpr (L + 1 < depth) {
+            if (std::get<L>(its_) != end_of<L>()) return equal<L + 1>(other);
+        }
+        return true;
+    }
+
+    maybe_const<level<0>>* root_ = nullptr;
+    decltype(iterators_of(std::make_index_sequence<depth>())) its_;
 };
 
 }  // namespace xtd
\ No newline at end of file
@@ -1,3 +1,16 @@
+#include <algorithm>
+#include <barrier>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "concurrent_multikey_map.hpp"
+#include "flat_multikey_map.hpp"
 #include "gtest/gtest.h"
 #include "multikey_map.hpp"
 
@@ -11,13 +24,13 @@ TEST(empty_initialiser_list, test_initialiser_list) {
     EXPECT_EQ(0, map.size());
 }
 
-// TEST(single_nested_initialiser_list, test_initialiser_list) {
-//     xtd::multikey_map<int, std::string> map = {
-//         {0, "hello"},
-//         {1, "world"},
-//     };
-//     EXPECT_EQ(2, map.size());
-// }
+TEST(single_nested_initialiser_list, test_initialiser_list) {
+    xtd::multikey_map<int, std::string> map = {
+        {0, "hello"},
+        {1, "world"},
+    };
+    EXPECT_EQ(2, map.size());
+}
 
 // TEST(double_nested_initialiser_list, test_initialiser_list) {
 //     xtd::multikey_map<int, int, std::string> map = {
@@ -48,4 +61,351 @@ TEST(copy_constructor, test_constructor) {
     xtd::multikey_map<int, char, int, std::string> map;
     map[3]['e'][0] = "hello world";
     EXPECT_EQ("hello world", map[3]['e'][0]);
-}
\ No newline at end of file
+}
+
+TEST(iteration, test_iteration) {
+    xtd::multikey_map<int, char, std::string> map = {
+        {1, 'a', "1a"},
+        {1, 'b', "1b"},
+        {2, 'a', "2a"},
+        {1, 'a', "duplicate"},
+    };
+    map[3]['z'];  // Leaves an inner map that is made empty below.
+    map[3].clear();
+    map[4];
+
+    std::vector<std::tuple<int, char, std::string>> rows(map.begin(), map.end());
+    std::sort(rows.begin(), rows.end());
+    EXPECT_EQ((std::vector<std::tuple<int, char, std::string>>{{1, 'a', "1a"}, {1, 'b', "1b"}, {2, 'a', "2a"}}), rows);
+
+    for (auto [key, letter, value] : map) value += letter;
+    EXPECT_EQ("2aa", map[2]['a']);
+
+    auto const& view = map;
+    xtd::multikey_map<int, char, std::string>::const_iterator it = map.begin();
+    EXPECT_EQ(view.begin(), it);
+    EXPECT_EQ(3, std::distance(view.begin(), view.end()));
+
+    xtd::multikey_map<int, std::string> empty;
+    EXPECT_EQ(empty.begin(), empty.end());
+}
+
+TEST(range_insert, test_range_insert) {
+    std::vector<std::tuple<int, int, int, long>> rows;
+    std::mt19937 random(3);
+    for (int i = 0; i < 10000; ++i) rows.emplace_back(random() % 30, random() % 30, random() % 30, i);
+
+    xtd::multikey_map<int, int, int, long> map;
+    map.insert(rows.begin(), rows.end());
+    for (auto const& [a, b, c, value] : rows) {
+        auto const& stored = map[a][b][c];
+        EXPECT_LE(stored, value);  // The first row for each key sequence wins.
+    }
+
+    std::vector<std::tuple<int, int, int, long>> dumped(map.begin(), map.end());
+    xtd::multikey_map<int, int, int, long> reloaded(dumped.begin(), dumped.end());
+    std::vector<std::tuple<int, int, int, long>> redumped(reloaded.begin(), reloaded.end());
+    std::sort(dumped.begin(), dumped.end());
+    std::sort(redumped.begin(), redumped.end());
+    EXPECT_EQ(dumped, redumped);
+
+    xtd::multikey_map<int, int, int, long> copied(std::as_const(map).begin(), std::as_const(map).end());
+    EXPECT_EQ(dumped.size(), static_cast<std::size_t>(std::distance(copied.begin(), copied.end())));
+    EXPECT_FALSE(map.insert({0, 0, 0, -1}) && map.insert({0, 0, 0, -2}));
+}
+
+TEST(flat_multikey_map, insert_find_and_erase) {
+    xtd::flat_multikey_map<int, char, std::string, double> map;
+    EXPECT_TRUE(map.empty());
+    map(1, 'a', "x") = 1.5;
+    EXPECT_TRUE(map.insert_or_assign(2, 'b', "y", 2.5));
+    EXPECT_FALSE(map.insert_or_assign(2, 'b', "y", 3.5));
+    EXPECT_EQ(2, map.size());
+
+    ASSERT_NE(nullptr, map.find(2, 'b', "y"));
+    EXPECT_EQ(3.5, *map.find(2, 'b', "y"));
+    EXPECT_EQ(1.5, map.at(1, 'a', "x"));
+    EXPECT_EQ(nullptr, map.find(2, 'a', "y"));
+    EXPECT_FALSE(map.contains(1, 'a', "y"));
+    EXPECT_EQ(2, map.size());
+    EXPECT_THROW(map.at(3, 'c', "z"), std::out_of_range);
+    EXPECT_FALSE(map.try_emplace(2, 'b', "y", 9.5).second);
+    EXPECT_EQ(3.5, map.at(2, 'b', "y"));
+    EXPECT_EQ(4.5, map.try_emplace(4, 'd', "w", 4.5).first);
+    EXPECT_TRUE(map.erase(4, 'd', "w"));
+
+    EXPECT_TRUE(map.erase(1, 'a', "x"));
+    EXPECT_FALSE(map.erase(1, 'a', "x"));
+    EXPECT_EQ(1, map.size());
+    EXPECT_EQ(3.5, map.at(2, 'b', "y"));
+}
+
+TEST(flat_multikey_map, matches_nested_unordered_maps) {
+    xtd::flat_multikey_map<int, int, int, long> flat;
+    std::unordered_map<int, std::unordered_map<int, std::unordered_map<int, long>>> nested;
+    std::mt19937 random(7);
+    for (int i = 0; i < 20000; ++i) {
+        int const a = random() % 50, b = random() % 50, c = random() % 50;
+        if (random() % 3 == 0) {
+            EXPECT_EQ(nested[a][b].erase(c) == 1, flat.erase(a, b, c));
+        } else {
+            nested[a][b][c] = i;
+            flat(a, b, c) = i;
+        }
+    }
+
+    std::size_t size = 0;
+    for (auto const& [a, inner] : nested) {
+        for (auto const& [b, innermost] : inner) {
+            for (auto const& [c, value] : innermost) {
+                ++size;
+                ASSERT_TRUE(flat.contains(a, b, c));
+                EXPECT_EQ(value, flat.at(a, b, c));
+            }
+        }
+    }
+    EXPECT_EQ(size, flat.size());
+    EXPECT_LE(flat.size(), flat.bucket_count() * 7 / 8);
+}
+
+TEST(flat_multikey_map, spreads_keys_differing_in_high_bits) {
+    // std::hash of an integer is the identity, so these keys only differ above bit 32.
+    std::set<std::size_t> groups, fingerprints;
+    for (std::uint64_t i = 0; i < 1024; ++i) {
+        auto const hash = xtd::detail::hash_keys(i << 32);
+        groups.insert((hash >> 7) & 63);
+        fingerprints.insert(hash & 0x7f);
+    }
+    EXPECT_EQ(64, groups.size());
+    EXPECT_EQ(128, fingerprints.size());
+
+    xtd::flat_multikey_map<int, int, int, int> map;
+    for (int i = 0; i < 20000; ++i) map.insert_or_assign(7, i << 16, 0, i);
+    for (int i = 0; i < 20000; ++i) ASSERT_EQ(i, map.at(7, i << 16, 0));
+    EXPECT_EQ(20000, map.size());
+}
+
+TEST(flat_multikey_map, reserve_avoids_rehashing) {
+    xtd::flat_multikey_map<int, int, int> map(1000);
+    auto const buckets = map.bucket_count();
+    EXPECT_GE(buckets * 7 / 8, 1000);
+    for (int i = 0; i < 1000; ++i) map.insert_or_assign(i, -i, i * i);
+    EXPECT_EQ(buckets, map.bucket_count());
+    EXPECT_EQ(81, map.at(9, -9));
+}
+
+TEST(flat_multikey_map, find_with_wildcards) {
+    using xtd::_;
+    xtd::flat_multikey_map<int, char, std::string, double> map;
+    map(1, 'a', "x") = 1;
+    map(1, 'b', "x") = 2;
+    map(2, 'a', "x") = 3;
+    map(2, 'a', "y") = 4;
+
+    auto const values = [](auto const& found) {
+        std::vector<double> result;
+        for (auto const& [keys, value] : found) result.push_back(value);
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    for (bool indexed : {false, true}) {
+        if (indexed) {
+            map.add_index<0>();
+            map.add_index<2>();
+        }
+        EXPECT_EQ((std::vector<double>{1, 2}), values(map.find(1, _, _)));
+        EXPECT_EQ((std::vector<double>{1, 3}), values(map.find(_, 'a', "x")));
+        EXPECT_EQ((std::vector<double>{4}), values(map.find(2, _, "y")));
+        EXPECT_EQ((std::vector<double>{1, 2, 3, 4}), values(map.find(_, _, _)));
+        EXPECT_TRUE(map.find(3, _, "x").empty());
+    }
+
+    for (auto [keys, value] : map.find(_, 'a', _)) value *= 10;
+    EXPECT_EQ(30, map.at(2, 'a', "x"));
+    EXPECT_EQ(10, map.at(1, 'a', "x"));
+    EXPECT_EQ(2, std::as_const(map).find(1, 'b', _).front().second);
+}
+
+TEST(flat_multikey_map, indexes_follow_erasure) {
+    using xtd::_;
+    xtd::flat_multikey_map<int, int, int, int> map;
+    map.add_index<1>();
+    std::mt19937 random(11);
+    for (int i = 0; i < 20000; ++i) {
+        int const a = random() % 20, b = random() % 20, c = random() % 20;
+        if (random() % 3 == 0) {
+            map.erase(a, b, c);
+        } else {
+            map.insert_or_assign(a, b, c, a + b + c);
+        }
+        if (i == 10000) map.add_index<2>();
+    }
+    EXPECT_TRUE(map.has_index<1>());
+    EXPECT_FALSE(map.has_index<0>());
+
+    std::size_t total = 0;
+    for (int b = 0; b < 20; ++b) {
+        for (int c = 0; c < 20; ++c) {
+            auto const found = map.find(_, b, c);
+            for (auto const& [keys, value] : found) {
+                EXPECT_EQ(b, std::get<1>(keys));
+                EXPECT_EQ(c, std::get<2>(keys));
+                EXPECT_EQ(std::get<0>(keys) + b + c, value);
+            }
+            std::size_t expected = 0;
+            for (int a = 0; a < 20; ++a) expected += map.contains(a, b, c);
+            EXPECT_EQ(expected, found.size());
+            total += found.size();
+        }
+    }
+    EXPECT_EQ(map.size(), total);
+
+    map.drop_index<1>();
+    map.clear();
+    map.insert_or_assign(1, 2, 3, 4);
+    EXPECT_EQ(1, map.find(_, _, 3).size());
+}
+
+TEST(concurrent_multikey_map, single_threaded_api) {
+    xtd::concurrent_multikey_map<int, std::string, long> map(5);
+    EXPECT_EQ(8, map.shard_count());
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.find(1, "a").has_value());
+    EXPECT_TRUE(map.empty());
+
+    EXPECT_TRUE(map.insert(1, "a", 10));
+    EXPECT_FALSE(map.insert(1, "a", 20));
+    EXPECT_EQ(10, map.find(1, "a"));
+    EXPECT_FALSE(map.insert_or_assign(1, "a", 30));
+    EXPECT_TRUE(map.insert_or_assign(2, "b", 40));
+    EXPECT_TRUE(map.update(2, "b", [](long& value) { ++value; }));
+    EXPECT_FALSE(map.update(3, "c", [](long& value) { ++value; }));
+
+    long seen = 0;
+    EXPECT_TRUE(map.visit(2, "b", [&](long const& value) { seen = value; }));
+    EXPECT_EQ(41, seen);
+    EXPECT_EQ(2, map.size());
+    EXPECT_TRUE(map.erase(1, "a"));
+    EXPECT_FALSE(map.contains(1, "a"));
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(concurrent_multikey_map, concurrent_readers_and_writers) {
+    xtd::concurrent_multikey_map<int, int, long> map;
+    map.reserve(8 * 5000);
+    constexpr int threads = 8;
+    constexpr int keys = 5000;
+
+    std::barrier inserted(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&map, &inserted, t] {
+            for (int i = 0; i < keys; ++i) map.insert_or_assign(t, i, 0);
+            inserted.arrive_and_wait();
+            for (int i = 0; i < keys; ++i) map.update(i % threads, i, [](long& value) { ++value; });
+            for (int i = 0; i < keys; ++i) EXPECT_GE(map.find((t + 1) % threads, i).value_or(0), 0);
+            for (int i = 0; i < keys; i += 2) map.erase(t, i);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    EXPECT_EQ(threads * keys / 2, map.size());
+    for (int i = 1; i < keys; i += 2) {
+        ASSERT_TRUE(map.contains(i % threads, i));
+        EXPECT_EQ(threads, map.find(i % threads, i));
+    }
+}
+
+TEST(flat_multikey_map, iteration_and_range_insert) {
+    xtd::flat_multikey_map<int, char, std::string> map = {{1, 'a', "1a"}, {2, 'b', "2b"}, {1, 'a', "duplicate"}};
+    EXPECT_EQ(2, map.size());
+    EXPECT_EQ("1a", map.at(1, 'a'));
+
+    for (auto [key, letter, value] : map) value += letter;
+    std::vector<std::tuple<int, char, std::string>> rows(std::as_const(map).begin(), std::as_const(map).end());
+    EXPECT_EQ((std::vector<std::tuple<int, char, std::string>>{{1, 'a', "1aa"}, {2, 'b', "2bb"}}), rows);
+
+    xtd::flat_multikey_map<int, char, std::string> copy(map.begin(), map.end());
+    EXPECT_EQ(2, copy.size());
+    EXPECT_FALSE(copy.insert({2, 'b', "other"}));
+    EXPECT_TRUE(copy.insert({3, 'c', "3c"}));
+    EXPECT_EQ("2bb", copy.at(2, 'b'));
+}
+
+TEST(range_insert, test_range_insert_ungrouped) {
+    // Shuffled rows over few first keys have almost as many runs as rows, which must not size the
+    // top level, nor reserve an inner map again each time a row returns to it.
+    std::vector<std::tuple<int, int, long>> rows;
+    for (int i = 0; i < 20000; ++i) rows.emplace_back(i % 10, i, i);
+    std::shuffle(rows.begin(), rows.end(), std::mt19937(5));
+
+    xtd::multikey_map<int, int, long> ranged(rows.begin(), rows.end());
+    xtd::multikey_map<int, int, long> rowwise;
+    for (auto const& row : rows) rowwise.insert(row);
+
+    EXPECT_EQ(10, ranged.size());
+    EXPECT_EQ(20000, std::distance(ranged.begin(), ranged.end()));
+    EXPECT_EQ(7, *ranged.find(7, 7));
+    std::vector<std::tuple<int, int, long>> dumped(ranged.begin(), ranged.end());
+    std::vector<std::tuple<int, int, long>> expected(rowwise.begin(), rowwise.end());
+    std::sort(dumped.begin(), dumped.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, dumped);
+
+    std::vector<std::tuple<int, long>> repeated;
+    for (auto const& [a, b, value] : rows) repeated.emplace_back(a, value);
+    xtd::multikey_map<int, long> top(repeated.begin(), repeated.end());
+    xtd::multikey_map<int, long> top_rowwise;
+    for (auto const& row : repeated) top_rowwise.insert(row);
+    EXPECT_EQ(10, top.size());
+    EXPECT_LE(top.memory_usage(), top_rowwise.memory_usage());
+}
+
+TEST(find, test_find_does_not_insert) {
+    xtd::multikey_map<int, char, std::string> map = {{1, 'a', "1a"}};
+    ASSERT_NE(nullptr, map.find(1, 'a'));
+    EXPECT_EQ("1a", *map.find(1, 'a'));
+    EXPECT_EQ(nullptr, map.find(2, 'a'));
+    EXPECT_EQ(nullptr, std::as_const(map).find(1, 'b'));
+    EXPECT_TRUE(map.contains(1, 'a'));
+    EXPECT_FALSE(map.contains(2, 'b'));
+    EXPECT_EQ(1, map.size());
+    EXPECT_EQ(0, map.compact());
+}
+
+TEST(erase, test_erase_prunes_empty_levels) {
+    xtd::multikey_map<int, int, int, long> map = {{1, 2, 3, 4}, {1, 2, 4, 5}};
+    EXPECT_FALSE(map.erase(1, 2, 5));
+    EXPECT_FALSE(map.erase(9, 2, 3));
+    EXPECT_TRUE(map.erase(1, 2, 3));
+    EXPECT_EQ(1, map.size());
+    EXPECT_TRUE(map.erase(1, 2, 4));
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(compact, test_compact_prunes_and_shrinks) {
+    xtd::multikey_map<int, int, int, long> map;
+    for (int a = 0; a < 50; ++a) {
+        for (int b = 0; b < 50; ++b) {
+            for (int c = 0; c < 10; ++c) map[a][b][c] = c;
+        }
+    }
+    auto const full = map.memory_usage();
+    EXPECT_GT(full, 25000 * sizeof(long));
+
+    // Failed lookups through operator[] leave empty inner maps behind, and clearing inner maps leaves
+    // their parents empty.
+    for (int a = 50; a < 100; ++a) map[a][0].count(0);
+    for (int a = 0; a < 49; ++a) {
+        for (int b = 0; b < 50; ++b) map[a][b].clear();
+    }
+    EXPECT_EQ(100, map.size());
+
+    EXPECT_EQ(50 + 50 + 49 * 50 + 49, map.compact());
+    EXPECT_EQ(1, map.size());  // Top level keys; the values are counted by iterating.
+    EXPECT_EQ(500, std::distance(map.begin(), map.end()));
+    EXPECT_EQ(9, *map.find(49, 49, 9));
+    EXPECT_LT(map.memory_usage() * 20, full);
+    EXPECT_EQ(0, map.compact());
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "zip.hpp"
+
+namespace xtd {
+
+// Sequence of rows with fields Ts..., stored as one contiguous array per field (structure of
+// arrays) rather than one array of structs.
+//
+// Rows are read and written through tuples of references, by index or by iterating the zip over
+// all columns. column<I>() exposes a single field as a span, and columns<I...>() zips just the
+// selected fields, so a scan only reads the arrays it touches and a loop over one column is as
+// vectorisable as a loop over a plain array.
+//
+// Every column always has size() elements: if constructing a field throws, the fields already added
+// to that row are removed again.
+template <typename... Ts>
+class soa_vector {
+    static_assert(sizeof...(Ts) > 0, "soa_vector needs at least one field");
+    static_assert((!std::is_same_v<Ts, bool> && ...), "std::vector<bool> columns are not contiguous");
+
+public:
+    using value_type = std::tuple<Ts...>;
+    using reference = std::tuple<Ts&...>;
+    using const_reference = std::tuple<Ts const&...>;
+    using size_type = std::size_t;
+
+    soa_vector() = default;
+
+    explicit soa_vector(size_type count) { resize(count); }
+
+    soa_vector(std::initializer_list<value_type> rows) {
+        reserve(rows.size());
+        for (auto const& row : rows) push_back(row);
+    }
+
+    auto operator[](size_type index) -> reference {
+        return std::apply([index](auto&... column) { return reference(column[index]...); }, columns_);
+    }
+
+    auto operator[](size_type index) const -> const_reference {
+        return std::apply([index](auto const&... column) { return const_reference(column[index]...); }, columns_);
+    }
+
+    auto front() -> reference { return (*this)[0]; }
+    auto front() const -> const_reference { return (*this)[0]; }
+
+    auto back() -> reference { return (*this)[size() - 1]; }
+    auto back() const -> const_reference { return (*this)[size() - 1]; }
+
+    // All rows, as an xtd::zip over every column.
+    auto rows() { return columns<>(); }
+    auto rows() const { return columns<>(); }
+
+    auto begin() { return rows().begin(); }
+    auto end() { return rows().end(); }
+
+    auto begin() const { return rows().begin(); }
+    auto end() const { return rows().end(); }
+
+    // The Ith field of every row, contiguous.
+    template <size_t I>
+    auto column() -> std::span<std::tuple_element_t<I, value_type>> {
+        return std::get<I>(columns_);
+    }
+
+    template <size_t I>
+    auto column() const -> std::span<std::tuple_element_t<I, value_type> const> {
+        return std::get<I>(columns_);
+    }
+
+    // The fields I... of every row, zipped. With no indices, every field.
+    template <size_t... I>
+    auto columns() {
+        if constexpr (sizeof...(I) == 0) {
+            return std::apply([](auto&... column) { return zip(column...); }, columns_);
+        } else {
+            return zip(std::get<I>(columns_)...);
+        }
+    }
+
+    template <size_t... I>
+    auto columns() const {
+        if constexpr (sizeof...(I) == 0) {
+            return std::apply([](auto const&... column) { return zip(column...); }, columns_);
+        } else {
+            return zip(std::get<I>(columns_)...);
+        }
+    }
+
+    auto empty() const -> bool { return size() == 0; }
+    auto size() const -> size_type { return std::get<0>(columns_).size(); }
+    auto capacity() const -> size_type { return std::get<0>(columns_).capacity(); }
+
+    auto reserve(size_type count) -> void {
+        std::apply([count](auto&... column) { (column.reserve(count), ...); }, columns_);
+    }
+
+    auto resize(size_type count) -> void {
+        auto const old = size();
+        try {
+            std::apply([count](auto&... column) { (column.resize(count), ...); }, columns_);
+        } catch (...) {
+            std::apply([old](auto&... column) { (column.resize(old), ...); }, columns_);
+            throw;
+        }
+    }
+
+    auto clear() -> void {
+        std::apply([](auto&... column) { (column.clear(), ...); }, columns_);
+    }
+
+    auto push_back(value_type const& row) -> void {
+        std::apply([this](auto const&... fields) { emplace_back(fields...); }, row);
+    }
+
+    auto push_back(value_type&& row) -> void {
+        std::apply([this](auto&... fields) { emplace_back(std::move(fields)...); }, row);
+    }
+
+    // Appends a row whose Ith field is constructed from the Ith argument.
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Ts))
+    auto emplace_back(Args&&... args) -> reference {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            size_t added = 0;
+            try {
+                ((std::get<I>(columns_).emplace_back(std::forward<Args>(args)), ++added), ...);
+            } catch (...) {
+                ((I < added ? std::get<I>(columns_).pop_back() : void()), ...);
+                throw;
+            }
+        }(std::index_sequence_for<Ts...>());
+        return back();
+    }
+
+    auto pop_back() -> void {
+        std::apply([](auto&... column) { (column.pop_back(), ...); }, columns_);
+    }
+
+    auto swap(soa_vector& other) noexcept -> void { columns_.swap(other.columns_); }
+
+    auto operator==(soa_vector const& other) const -> bool = default;
+
+private:
+    std::tuple<std::vector<Ts>...> columns_;
+};
+
+}  // namespace xtd
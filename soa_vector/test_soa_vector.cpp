@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+
+#include "doctest.h"
+#include "soa_vector.hpp"
+
+TEST_CASE("push_back and operator[]") {
+    xtd::soa_vector<int, std::string, double> v;
+    CHECK(v.empty());
+    v.push_back({1, "one", 1.5});
+    v.emplace_back(2, "two", 2.5);
+    CHECK(v.size() == 2);
+    CHECK(v[0] == std::tuple(1, "one", 1.5));
+    CHECK(v.back() == std::tuple(2, "two", 2.5));
+
+    std::get<1>(v[1]) = "deux";
+    CHECK(v.column<1>()[1] == "deux");
+
+    v.pop_back();
+    CHECK(v.size() == 1);
+    CHECK(v.front() == std::tuple(1, "one", 1.5));
+}
+
+TEST_CASE("reserve, resize and clear") {
+    xtd::soa_vector<int, double> v(3);
+    CHECK(v.size() == 3);
+    CHECK(v[2] == std::tuple(0, 0.0));
+    v.reserve(100);
+    CHECK(v.capacity() >= 100);
+    CHECK(v.column<0>().size() == 3);
+    v.resize(1);
+    CHECK(v.column<1>().size() == 1);
+    v.clear();
+    CHECK(v.empty());
+}
+
+TEST_CASE("columns are contiguous") {
+    xtd::soa_vector<int, float> v = {{1, 0.5f}, {2, 1.5f}, {3, 2.5f}};
+    auto ints = v.column<0>();
+    CHECK(ints.data() + 2 == &std::get<0>(v[2]));
+    CHECK(std::accumulate(ints.begin(), ints.end(), 0) == 6);
+
+    for (auto& f : v.column<1>()) f *= 2;
+    CHECK(v[2] == std::tuple(3, 5.0f));
+}
+
+TEST_CASE("rows and selected columns are zip views") {
+    xtd::soa_vector<int, char, double> v = {{3, 'c', 0.3}, {1, 'a', 0.1}, {2, 'b', 0.2}};
+    static_assert(std::ranges::random_access_range<decltype(v.rows())>);
+
+    for (auto [i, c, d] : v) {
+        i *= 10;
+        d = -d;
+    }
+    CHECK(v[1] == std::tuple(10, 'a', -0.1));
+
+    int sum = 0;
+    for (auto [i, d] : v.columns<0, 2>()) sum += i;
+    CHECK(sum == 60);
+
+    auto const& cv = v;
+    auto found = std::ranges::find_if(cv.rows(), [](auto row) { return std::get<1>(row) == 'b'; });
+    CHECK(found - cv.begin() == 2);
+    CHECK(std::ranges::distance(cv.columns<1>()) == 3);
+}
+
+struct Fragile {
+    explicit Fragile(int value) {
+        if (value < 0) throw std::invalid_argument("negative");
+    }
+};
+
+TEST_CASE("a throwing field leaves every column the same size") {
+    xtd::soa_vector<int, Fragile> v;
+    v.emplace_back(1, 1);
+    CHECK_THROWS_AS(v.emplace_back(2, -1), std::invalid_argument);
+    CHECK(v.size() == 1);
+    CHECK(v.column<0>().size() == 1);
+    CHECK(v.column<1>().size() == 1);
+}
@@ -0,0 +1,44 @@
+#include "directed_weighted_graph.hpp"
+#include "gtest/gtest.h"
+#include "triangle_count.hpp"
+
+TEST(triangle_count, empty_graph) {
+    auto g = xtd::directed_weighted_graph<int, int>();
+    EXPECT_EQ(0, xtd::triangle_count(g));
+}
+
+TEST(triangle_count, single_triangle) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(2, 3, 1);
+    g.insert_edge(3, 1, 1);
+    EXPECT_EQ(1, xtd::triangle_count(g));
+}
+
+TEST(triangle_count, ignores_direction_self_loops_and_parallel_edges) {
+    auto g = xtd::directed_weighted_graph<int, int>({1, 2, 3});
+    g.insert_edge(1, 2, 1);
+    g.insert_edge(2, 1, 1);
+    g.insert_edge(1, 2, 2);
+    g.insert_edge(1, 3, 1);
+    g.insert_edge(2, 3, 1);
+    g.insert_edge(3, 3, 1);
+    EXPECT_EQ(1, xtd::triangle_count(g));
+}
+
+TEST(triangle_count, complete_graph) {
+    auto g = xtd::directed_weighted_graph<int, int>({0, 1, 2, 3, 4, 5});
+    for (auto u = 0; u < 6; ++u) {
+        for (auto v = u + 1; v < 6; ++v) {
+            g.insert_edge(u, v, 1);
+        }
+    }
+    EXPECT_EQ(20, xtd::triangle_count(g));
+}
+
+TEST(triangle_count, sorted_intersection_size) {
+    auto a = std::vector<int>({1, 3, 4, 7, 9});
+    auto b = std::vector<int>({0, 3, 7, 8, 9, 10});
+    EXPECT_EQ(3, xtd::sorted_intersection_size(a.begin(), a.end(), b.begin(), b.end()));
+    EXPECT_EQ(0, xtd::sorted_intersection_size(a.begin(), a.end(), b.end(), b.end()));
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "zip.hpp"
+#include "zip_transform_reduce.hpp"
+
+// Dot products, weighted sums and squared distances over zipped columns: the naive Zip loop, the
+// xtd::zip loop, std::inner_product and xtd::zip_transform_reduce, on inputs that fit in L1 and on
+// inputs that only fit in memory.
+
+using Clock = std::chrono::steady_clock;
+
+// Stops the compiler from discarding a value that is computed only to be measured.
+template <typename T>
+auto doNotOptimise(T const& value) -> void {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Returns the nanoseconds per element taken by kernel over n elements, repeated until about 2^26
+// elements have been processed.
+template <typename Kernel>
+auto measure(size_t n, Kernel kernel) -> double {
+    auto const repeats = std::max<size_t>(1, (size_t{1} << 26) / n);
+    auto const start = Clock::now();
+    for (size_t r = 0; r < repeats; ++r) doNotOptimise(kernel());
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (repeats * n);
+}
+
+template <typename T>
+auto dot(size_t n) -> void {
+    std::vector<T> a(n), b(n);
+    std::iota(a.begin(), a.end(), T(1));
+    std::iota(b.begin(), b.end(), T(2));
+
+    auto const naive = measure(n, [&] {
+        T sum = 0;
+        for (auto p : Zip(a.begin(), a.end(), b.begin(), b.end())) sum += p.first * p.second;
+        return sum;
+    });
+    auto const zipped = measure(n, [&] {
+        T sum = 0;
+        for (auto [x, y] : xtd::zip(a, b)) sum += x * y;
+        return sum;
+    });
+    auto const inner = measure(n, [&] { return std::inner_product(a.begin(), a.end(), b.begin(), T(0)); });
+    auto const kernel = measure(n, [&] { return xtd::zip_transform_reduce(T(0), std::plus<>(), std::multiplies<>(), a, b); });
+    std::printf("%-22s %10zu %10.3f %10.3f %10.3f %10.3f\n", sizeof(T) == 4 ? "dot (float)" : "dot (double)", n, naive,
+                zipped, inner, kernel);
+}
+
+auto weightedSum(size_t n) -> void {
+    std::vector<double> values(n, 1.5), weights(n, 0.25), mask(n, 1.0);
+    auto const naive = measure(n, [&] {
+        double sum = 0;
+        for (auto [v, w, m] : xtd::zip(values, weights, mask)) sum += v * w * m;
+        return sum;
+    });
+    auto const kernel = measure(n, [&] {
+        return xtd::zip_transform_reduce(0.0, std::plus<>(), [](double v, double w, double m) { return v * w * m; },
+                                         values, weights, mask);
+    });
+    std::printf("%-22s %10zu %10s %10.3f %10s %10.3f\n", "weighted sum", n, "-", naive, "-", kernel);
+}
+
+auto squaredDistance(size_t n) -> void {
+    std::vector<float> p(n, 1.0f), q(n, 3.0f);
+    auto const naive = measure(n, [&] {
+        float sum = 0;
+        for (auto pair : Zip(p.begin(), p.end(), q.begin(), q.end())) {
+            sum += (pair.first - pair.second) * (pair.first - pair.second);
+        }
+        return sum;
+    });
+    auto const kernel = measure(n, [&] {
+        return xtd::zip_transform_reduce(0.0f, std::plus<>(), [](float x, float y) { return (x - y) * (x - y); }, p, q);
+    });
+    std::printf("%-22s %10zu %10.3f %10s %10s %10.3f\n", "squared distance", n, naive, "-", "-", kernel);
+}
+
+int main() {
+    std::printf("%-22s %10s %10s %10s %10s %10s\n", "ns/element", "n", "Zip", "xtd::zip", "inner", "kernel");
+    for (size_t n : {size_t{1} << 10, size_t{1} << 22}) {
+        dot<float>(n);
+        dot<double>(n);
+        weightedSum(n);
+        squaredDistance(n);
+    }
+}
@@ -1,3 +1,16 @@
+#include <array>
+#include <cmath>
+#include <execution>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -5,6 +18,7 @@
 
 #include "doctest.h"
 #include "zip.hpp"
+#include "zip_transform_reduce.hpp"
 
 namespace std {
 template <typename U, typename V>
@@ -131,3 +145,219 @@ TEST_CASE("C-style arrays") {
     CHECK(std::pair<double, double>(1, 5) == actual[1]);
     CHECK(std::pair<double, double>(2, 6) == actual[2]);
 }
+
+TEST_CASE("xtd::zip yields tuples of references") {
+    std::vector<int> ints = {0, 1, 2, 3, 4};
+    std::vector<char> chars = {'a', 'b', 'c', 'd', 'e'};
+    std::vector<double> doubles = {0.5, 1.5, 2.5, 3.5, 4.5};
+    auto zipped = xtd::zip(ints, chars, doubles);
+
+    static_assert(std::ranges::random_access_range<decltype(zipped)>);
+    static_assert(std::ranges::sized_range<decltype(zipped)>);
+    static_assert(std::ranges::common_range<decltype(zipped)>);
+    static_assert(std::is_same_v<std::ranges::range_reference_t<decltype(zipped)>, std::tuple<int&, char&, double&>>);
+
+    CHECK(zipped.size() == 5);
+    CHECK(zipped[2] == std::tuple(2, 'c', 2.5));
+    for (auto [i, c, d] : zipped) {
+        i *= 10;
+        c = static_cast<char>(c - 'a' + 'A');
+        d = -d;
+    }
+    CHECK(ints == std::vector<int>{0, 10, 20, 30, 40});
+    CHECK(chars == std::vector<char>{'A', 'B', 'C', 'D', 'E'});
+    CHECK(doubles[4] == -4.5);
+}
+
+TEST_CASE("xtd::zip iterators") {
+    std::vector<int> ints = {0, 1, 2, 3, 4};
+    std::array<char, 5> chars = {'a', 'b', 'c', 'd', 'e'};
+    auto const zipped = xtd::zip(ints, chars);
+
+    auto begin = zipped.begin();
+    auto end = zipped.end();
+    CHECK(end - begin == 5);
+    CHECK(*(begin + 4) == std::tuple(4, 'e'));
+    CHECK(*(end - 5) == std::tuple(0, 'a'));
+    CHECK(begin < end);
+    CHECK(begin + 5 == end);
+    CHECK(begin[3] == std::tuple(3, 'd'));
+    CHECK(*--end == std::tuple(4, 'e'));
+    CHECK(std::ranges::distance(zipped) == 5);
+
+    auto found = std::ranges::find_if(zipped, [](auto t) { return std::get<1>(t) == 'c'; });
+    CHECK(found - zipped.begin() == 2);
+}
+
+TEST_CASE("xtd::zip stops at the shortest range") {
+    std::vector<int> ints = {0, 1, 2, 3, 4};
+    std::vector<char> chars = {'a', 'b', 'c'};
+    CHECK(xtd::zip(ints, chars).size() == 3);
+    CHECK(std::ranges::distance(xtd::zip(ints, chars)) == 3);
+
+    // A list is not random access, so the end is a sentinel.
+    std::list<int> list = {7, 8};
+    auto zipped = xtd::zip(ints, list);
+    static_assert(std::ranges::bidirectional_range<decltype(zipped)>);
+    static_assert(!std::ranges::common_range<decltype(zipped)>);
+    std::vector<std::tuple<int, int>> pairs(zipped.begin(), std::ranges::next(zipped.begin(), zipped.end()));
+    CHECK(pairs == std::vector<std::tuple<int, int>>{{0, 7}, {1, 8}});
+}
+
+TEST_CASE("xtd::zip of views and temporaries") {
+    auto zipped = xtd::zip(std::views::iota(0), std::vector<int>{5, 6, 7});
+    std::vector<int> sums;
+    for (auto [i, v] : zipped) sums.push_back(i + v);
+    CHECK(sums == std::vector<int>{5, 7, 9});
+}
+
+TEST_CASE("xtd::zip of const ranges") {
+    std::vector<int> const ints = {0, 1, 2};
+    std::vector<char> chars = {'a', 'b', 'c'};
+    auto zipped = xtd::zip(ints, chars);
+    static_assert(std::ranges::random_access_range<decltype(zipped)>);
+    static_assert(std::is_same_v<std::ranges::range_reference_t<decltype(zipped)>, std::tuple<int const&, char&>>);
+
+    std::vector<std::ranges::range_value_t<decltype(zipped)>> copies(zipped.begin(), zipped.end());
+    auto [i, c] = copies[1];
+    CHECK(i == 1);
+    CHECK(c == 'b');
+    CHECK(std::ranges::count_if(zipped, [](auto t) { return std::get<0>(t) > 0; }) == 2);
+}
+
+TEST_CASE("Zip iterators are random access") {
+    using Iterator = decltype(Zip(std::vector<int>::iterator(), std::vector<int>::iterator(),
+                                  std::vector<char>::iterator(), std::vector<char>::iterator())
+                                  .begin());
+    static_assert(std::random_access_iterator<Iterator>);
+    static_assert(std::is_same_v<std::iterator_traits<Iterator>::iterator_category, std::random_access_iterator_tag>);
+
+    std::vector<int> vec1 = {0, 1, 2, 3, 4};
+    std::vector<char> vec2 = {'a', 'b', 'c', 'd', 'e'};
+    auto actual = Zip(vec1.begin(), vec1.end(), vec2.begin(), vec2.end());
+    CHECK(actual.end() - actual.begin() == 5);
+    CHECK(std::distance(actual.begin(), actual.end()) == 5);
+    CHECK(actual.begin() < actual.end());
+    CHECK((actual.begin() <=> actual.begin() + 1) == std::strong_ordering::less);
+    CHECK(std::pair<int, char>(3, 'd') == actual.begin()[3]);
+    CHECK(std::pair<int, char>(2, 'c') == *(2 + actual.begin()));
+}
+
+TEST_CASE("parallel algorithms") {
+    std::vector<double> prices(10000), quantities(10000), totals(10000);
+    std::iota(prices.begin(), prices.end(), 1.0);
+    std::fill(quantities.begin(), quantities.end(), 2.0);
+
+    auto legacy = Zip(prices.begin(), prices.end(), quantities.begin(), quantities.end());
+    auto const sum = std::transform_reduce(std::execution::par, legacy.begin(), legacy.end(), 0.0, std::plus<>(),
+                                           [](auto p) { return p.first * p.second; });
+    CHECK(sum == 10000.0 * 10001.0);
+
+    auto zipped = xtd::zip(prices, quantities, totals);
+    std::for_each(std::execution::par_unseq, zipped.begin(), zipped.end(),
+                  [](auto row) { std::get<2>(row) = std::get<0>(row) * std::get<1>(row); });
+    CHECK(totals[0] == 2.0);
+    CHECK(totals[9999] == 20000.0);
+    CHECK(std::transform_reduce(std::execution::par_unseq, zipped.begin(), zipped.end(), 0.0, std::plus<>(),
+                                [](auto row) { return std::get<2>(row); }) == sum);
+}
+
+TEST_CASE("zip_transform_reduce") {
+    SUBCASE("contiguous arithmetic ranges, at every length and alignment") {
+        std::vector<double> a(300), b(300);
+        std::iota(a.begin(), a.end(), 1.0);
+        std::iota(b.begin(), b.end(), -50.0);
+        bool matches = true;
+        for (size_t offset = 0; offset < 9; ++offset) {
+            for (size_t n = 0; n + offset <= a.size(); n += 7) {
+                std::span x(a.data() + offset, n), y(b.data() + offset, n);
+                auto const expected = std::inner_product(x.begin(), x.end(), y.begin(), 0.0);
+                auto const actual = xtd::zip_transform_reduce(0.0, std::plus<>(), std::multiplies<>(), x, y);
+                matches &= actual == expected;
+            }
+        }
+        CHECK(matches);
+    }
+
+    SUBCASE("weighted sum of three columns") {
+        std::vector<float> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+                                     25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40};
+        std::vector<float> weights(values.size(), 0.5f);
+        std::vector<int> mask(values.size(), 1);
+        mask[3] = 0;
+        auto const sum = xtd::zip_transform_reduce(0.0f, std::plus<>(), [](float v, float w, int m) { return v * w * m; },
+                                                   values, weights, mask);
+        CHECK(sum == (820.0f - 4.0f) / 2);
+    }
+
+    SUBCASE("squared distance") {
+        std::array<double, 3> p = {1, 2, 3}, q = {4, 6, 3};
+        auto const d = xtd::zip_transform_reduce(0.0, std::plus<>(), [](double x, double y) { return (x - y) * (x - y); }, p, q);
+        CHECK(std::sqrt(d) == 5.0);
+    }
+
+    SUBCASE("generic ranges") {
+        std::list<int> list = {1, 2, 3, 4};
+        auto const max = xtd::zip_transform_reduce(
+            0, [](int x, int y) { return std::max(x, y); }, [](int x, int i) { return x * i; }, list, std::views::iota(1));
+        CHECK(max == 16);
+
+        std::vector<std::string> words = {"a", "bb", "ccc"};
+        auto const length = xtd::zip_transform_reduce(size_t{0}, std::plus<>(), [](std::string const& w) { return w.size(); }, words);
+        CHECK(length == 6);
+    }
+}
+
+TEST_CASE("Zip of unequal lengths") {
+    std::vector<int> vec1 = {0, 1, 2, 3, 4};
+    std::list<char> list = {'a', 'b', 'c'};
+    auto actual = Zip(vec1.begin(), vec1.end(), list.begin(), list.end());
+    CHECK(std::distance(actual.begin(), actual.end()) == 3);
+    CHECK(std::pair<int, char>(2, 'c') == *std::next(actual.begin(), 2));
+
+    // Input iterators are not measured up front, which would consume the stream.
+    std::istringstream input("10 20 30");
+    auto streamed = Zip(std::istream_iterator<int>(input), std::istream_iterator<int>(), vec1.begin(), vec1.end());
+    int sum = 0;
+    for (auto [value, index] : streamed) sum += value * index;
+    CHECK(sum == 80);
+
+    std::vector<char> vec2 = {'a', 'b'};
+    auto indexed = Zip(vec1.begin(), vec1.end(), vec2.begin(), vec2.end());
+    CHECK(indexed.size() == 2);
+    CHECK(std::pair<int, char>(1, 'b') == *std::prev(indexed.end()));
+    CHECK(std::pair<int, char>(1, 'b') == indexed.at(1));
+    CHECK_THROWS_AS(indexed.at(2), std::out_of_range);
+}
+
+TEST_CASE("xtd::zip over a stream of unknown length") {
+    std::istringstream input("10 20 30");
+    std::vector<int> weights = {1, 2, 3, 4, 5};
+    auto zipped = xtd::zip(std::views::istream<int>(input), weights);
+    static_assert(std::ranges::input_range<decltype(zipped)>);
+
+    int sum = 0;
+    for (auto [value, weight] : zipped) sum += value * weight;
+    CHECK(sum == 140);
+}
+
+TEST_CASE("xtd::zip_longest") {
+    std::vector<int> ints = {0, 1, 2};
+    std::list<char> chars = {'a'};
+    auto zipped = xtd::zip_longest(ints, chars);
+    static_assert(std::ranges::forward_range<decltype(zipped)>);
+    CHECK(zipped.size() == 3);
+
+    std::vector<std::tuple<std::optional<int>, std::optional<char>>> rows(zipped.begin(), std::ranges::next(zipped.begin(), zipped.end()));
+    CHECK(rows.size() == 3);
+    CHECK(rows[0] == std::tuple(std::optional(0), std::optional('a')));
+    CHECK(rows[1] == std::tuple(std::optional(1), std::optional<char>()));
+    CHECK(rows[2] == std::tuple(std::optional(2), std::optional<char>()));
+
+    std::istringstream input("7 8");
+    std::vector<int> values;
+    for (auto [streamed, stored] : xtd::zip_longest(std::views::istream<int>(input), std::vector<int>{1, 2, 3})) {
+        values.push_back(streamed.value_or(0) + *stored);
+    }
+    CHECK(values == std::vector<int>{8, 10, 3});
+}
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <optional>
 #include <ranges>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 
 template <typename It1, typename It2>
 class Zip {
@@ -15,17 +24,37 @@ public:
                   typename std::conditional_t<std::is_pointer_v<It2>, typename std::remove_pointer_t<It2>,
                                               typename std::iterator_traits<It2>::value_type> >;
     using iterator_type = iterator<It1, It2>;
+    using difference_type = std::common_type_t<typename std::iterator_traits<It1>::difference_type,
+                                               typename std::iterator_traits<It2>::difference_type>;
 
+    static constexpr bool random_access =
+        std::derived_from<std::common_type_t<typename std::iterator_traits<It1>::iterator_category,
+                                             typename std::iterator_traits<It2>::iterator_category>,
+                          std::random_access_iterator_tag>;
+
+    // Random access, and usable with the parallel algorithms, when both iterators are. Dereferencing
+    // yields copies, so use xtd::zip to write through to the underlying ranges.
     template <typename FirstIteratorType, typename SecondIteratorType>
     class iterator {
     public:
         friend class Zip;
+        using iterator_category = std::common_type_t<typename std::iterator_traits<FirstIteratorType>::iterator_category,
+                                                     typename std::iterator_traits<SecondIteratorType>::iterator_category>;
         using value_type = Zip::value_type;
+        using difference_type = std::common_type_t<typename std::iterator_traits<FirstIteratorType>::difference_type,
+                                                   typename std::iterator_traits<SecondIteratorType>::difference_type>;
+        using reference = value_type;
 
         iterator() = default;
 
+        // Holds the dereferenced pair so that operator-> can return a pointer to it without allocating.
+        struct arrow {
+            value_type value;
+            auto operator->() const -> value_type const* { return &value; }
+        };
+
         auto operator*() const -> value_type { return {*iter1, *iter2}; }
-        auto operator->() const -> std::shared_ptr<value_type> { return std::make_shared<value_type>(operator*()); }
+        auto operator->() const -> arrow { return {operator*()}; }
 
         auto operator++() -> iterator& {
             iter1++;
@@ -51,16 +80,39 @@ public:
             return temp;
         }
 
-        auto operator+(int offset) const -> iterator { return iterator(iter1 + offset, iter2 + offset); }
-        auto operator-(int offset) const -> iterator { return iterator(iter1 - offset, iter2 - offset); }
+        auto operator+=(difference_type offset) -> iterator& {
+            iter1 += offset;
+            iter2 += offset;
+            return *this;
+        }
+
+        auto operator-=(difference_type offset) -> iterator& { return *this += -offset; }
 
-        auto operator<=>(iterator const& other) const -> int {
-            if (iter1 < other.iter1 || iter2 < other.iter2) return -1;
-            if (iter1 > other.iter1 || iter2 > other.iter2) return 1;
-            return 0;
+        auto operator+(difference_type offset) const -> iterator { return iterator(iter1 + offset, iter2 + offset); }
+        auto operator-(difference_type offset) const -> iterator { return iterator(iter1 - offset, iter2 - offset); }
+
+        friend auto operator+(difference_type offset, iterator const& it) -> iterator { return it + offset; }
+
+        // Both iterators move together, so the first alone gives the distance and the order.
+        auto operator-(iterator const& other) const -> difference_type {
+            return static_cast<difference_type>(iter1 - other.iter1);
         }
 
-        auto operator==(iterator const& other) const -> bool = default;
+        auto operator[](difference_type offset) const -> value_type { return *(*this + offset); }
+
+        auto operator<=>(iterator const& other) const { return iter1 <=> other.iter1; }
+
+        // A random access Zip is trimmed so that both iterators reach end() together, and the first
+        // alone decides. Otherwise the ranges may differ in length, so an iterator is equal to
+        // another as soon as either of its iterators is, which stops a loop at the shorter range. The
+        // two comparisons are combined with a bitwise or, so a step costs a single branch.
+        auto operator==(iterator const& other) const -> bool {
+            if constexpr (random_access) {
+                return iter1 == other.iter1;
+            } else {
+                return static_cast<bool>((iter1 == other.iter1) | (iter2 == other.iter2));
+            }
+        }
         auto operator!=(iterator const& other) const -> bool = default;
 
     private:
@@ -70,10 +122,33 @@ public:
         SecondIteratorType iter2;
     };
 
-    Zip(It1 first1, It1 last1, It2 first2, It2 last2) : first1(first1), last1(last1), first2(first2), last2(last2) {}
+    // If both iterators are random access, the longer range is trimmed to the length of the shorter
+    // one, so that both iterators reach end() together. Other ranges are not measured, as that would
+    // walk them and consume input iterators; iteration stops when either range ends instead.
+    Zip(It1 first1, It1 last1, It2 first2, It2 last2) : first1(first1), last1(last1), first2(first2), last2(last2) {
+        if constexpr (random_access) {
+            auto const size = std::min<difference_type>(last1 - first1, last2 - first2);
+            this->last1 = first1 + size;
+            this->last2 = first2 + size;
+        }
+    }
 
     auto operator[](size_t index) const -> value_type { return {first1[index], first2[index]}; }
 
+    // As operator[], but throws std::out_of_range if index is past the end of the shorter range.
+    auto at(size_t index) const -> value_type
+        requires random_access
+    {
+        if (index >= size()) throw std::out_of_range("Zip::at");
+        return (*this)[index];
+    }
+
+    auto size() const -> size_t
+        requires random_access
+    {
+        return static_cast<size_t>(last1 - first1);
+    }
+
     auto begin() -> iterator_type { return {first1, first2}; }
     auto end() -> iterator_type { return {last1, last2}; }
 
@@ -91,4 +166,401 @@ private:
     // Second container.
     It2 first2;
     It2 last2;
-};
\ No newline at end of file
+};
+
+namespace xtd {
+
+namespace detail {
+
+template <bool Const, typename T>
+using maybe_const = std::conditional_t<Const, T const, T>;
+
+template <bool Const, typename... Views>
+concept all_forward = (std::ranges::forward_range<maybe_const<Const, Views>> && ...);
+
+template <bool Const, typename... Views>
+concept all_bidirectional = (std::ranges::bidirectional_range<maybe_const<Const, Views>> && ...);
+
+template <bool Const, typename... Views>
+concept all_random_access = (std::ranges::random_access_range<maybe_const<Const, Views>> && ...);
+
+template <bool Const, typename... Views>
+concept all_sized = (std::ranges::sized_range<maybe_const<Const, Views>> && ...);
+
+}  // namespace detail
+
+// Value type of zip_view iterators, which behaves as a std::tuple<Ts...>.
+//
+// It is a distinct type only so that it can specialise std::basic_common_reference, as C++23 does
+// for std::tuple itself. Without that, a tuple of const references and a tuple of values have no
+// common reference, and zips of const ranges would not satisfy the range concepts.
+template <typename... Ts>
+struct zip_value : std::tuple<Ts...> {
+    using std::tuple<Ts...>::tuple;
+};
+
+// View over N ranges in lockstep, whose elements are tuples of references to the elements of each
+// range at the same position. It stops at the end of the shortest range.
+//
+// The zip is as strong as its weakest range: random access if all ranges are random access, and so
+// on. Iterators advance every underlying iterator, but since they all move together, comparing two
+// zip iterators only compares the first. If every range is random access and sized, end() is
+// begin() advanced by the shortest size, so loops over the zip test a single iterator per step,
+// like a hand-written indexed loop.
+template <std::ranges::input_range... Views>
+    requires(std::ranges::view<Views> && ...) && (sizeof...(Views) > 0)
+class zip_view : public std::ranges::view_interface<zip_view<Views...>> {
+public:
+    template <bool Const>
+    class iterator;
+    template <bool Const>
+    class sentinel;
+
+    template <bool Const>
+    class iterator {
+        using iterators = std::tuple<std::ranges::iterator_t<detail::maybe_const<Const, Views>>...>;
+
+    public:
+        friend class zip_view;
+        template <bool>
+        friend class sentinel;
+
+        using iterator_concept = std::conditional_t<
+            detail::all_random_access<Const, Views...>, std::random_access_iterator_tag,
+            std::conditional_t<detail::all_bidirectional<Const, Views...>, std::bidirectional_iterator_tag,
+                               std::conditional_t<detail::all_forward<Const, Views...>, std::forward_iterator_tag,
+                                                  std::input_iterator_tag>>>;
+        // Also advertised to the C++17 algorithms, including the parallel ones, although reference is
+        // a tuple of references rather than value_type&.
+        using iterator_category = iterator_concept;
+        using value_type = zip_value<std::ranges::range_value_t<detail::maybe_const<Const, Views>>...>;
+        using reference = std::tuple<std::ranges::range_reference_t<detail::maybe_const<Const, Views>>...>;
+        using difference_type = std::common_type_t<std::ranges::range_difference_t<detail::maybe_const<Const, Views>>...>;
+
+        iterator() = default;
+
+        auto operator*() const -> reference {
+            return std::apply([](auto const&... it) { return reference(*it...); }, current);
+        }
+
+        auto operator[](difference_type n) const -> reference
+            requires detail::all_random_access<Const, Views...>
+        {
+            return *(*this + n);
+        }
+
+        auto operator++() -> iterator& {
+            std::apply([](auto&... it) { (++it, ...); }, current);
+            return *this;
+        }
+
+        auto operator++(int) {
+            if constexpr (detail::all_forward<Const, Views...>) {
+                auto temp = *this;
+                ++*this;
+                return temp;
+            } else {
+                ++*this;
+            }
+        }
+
+        auto operator--() -> iterator&
+            requires detail::all_bidirectional<Const, Views...>
+        {
+            std::apply([](auto&... it) { (--it, ...); }, current);
+            return *this;
+        }
+
+        auto operator--(int) -> iterator
+            requires detail::all_bidirectional<Const, Views...>
+        {
+            auto temp = *this;
+            --*this;
+            return temp;
+        }
+
+        auto operator+=(difference_type n) -> iterator&
+            requires detail::all_random_access<Const, Views...>
+        {
+            std::apply([n](auto&... it) { ((it += static_cast<std::iter_difference_t<std::remove_reference_t<decltype(it)>>>(n)), ...); },
+                       current);
+            return *this;
+        }
+
+        auto operator-=(difference_type n) -> iterator&
+            requires detail::all_random_access<Const, Views...>
+        {
+            return *this += -n;
+        }
+
+        friend auto operator+(iterator it, difference_type n) -> iterator
+            requires detail::all_random_access<Const, Views...>
+        {
+            return it += n;
+        }
+
+        friend auto operator+(difference_type n, iterator it) -> iterator
+            requires detail::all_random_access<Const, Views...>
+        {
+            return it += n;
+        }
+
+        friend auto operator-(iterator it, difference_type n) -> iterator
+            requires detail::all_random_access<Const, Views...>
+        {
+            return it -= n;
+        }
+
+        friend auto operator-(iterator const& lhs, iterator const& rhs) -> difference_type
+            requires detail::all_random_access<Const, Views...>
+        {
+            return static_cast<difference_type>(std::get<0>(lhs.current) - std::get<0>(rhs.current));
+        }
+
+        friend auto operator==(iterator const& lhs, iterator const& rhs) -> bool
+            requires detail::all_forward<Const, Views...>
+        {
+            return std::get<0>(lhs.current) == std::get<0>(rhs.current);
+        }
+
+        friend auto operator<=>(iterator const& lhs, iterator const& rhs)
+            requires detail::all_random_access<Const, Views...>
+        {
+            return std::get<0>(lhs.current) <=> std::get<0>(rhs.current);
+        }
+
+    private:
+        explicit iterator(iterators current) : current(std::move(current)) {}
+
+        iterators current;
+    };
+
+    // End of a zip whose end cannot be computed up front, such as a zip over a stream: reached as
+    // soon as any range ends. The comparisons are combined with a bitwise or, so a step costs a
+    // single branch however many ranges are zipped.
+    template <bool Const>
+    class sentinel {
+        using sentinels = std::tuple<std::ranges::sentinel_t<detail::maybe_const<Const, Views>>...>;
+
+    public:
+        friend class zip_view;
+
+        sentinel() = default;
+
+        friend auto operator==(iterator<Const> const& it, sentinel const& end) -> bool { return end.reached(it); }
+
+    private:
+        explicit sentinel(sentinels ends) : ends(std::move(ends)) {}
+
+        auto reached(iterator<Const> const& it) const -> bool {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return static_cast<bool>(((std::get<I>(it.current) == std::get<I>(ends)) | ...));
+            }(std::index_sequence_for<Views...>());
+        }
+
+        sentinels ends;
+    };
+
+    zip_view() = default;
+    explicit zip_view(Views... views) : views(std::move(views)...) {}
+
+    auto begin() -> iterator<false> { return makeBegin<false>(views); }
+
+    auto begin() const -> iterator<true>
+        requires(std::ranges::range<Views const> && ...)
+    {
+        return makeBegin<true>(views);
+    }
+
+    auto end() { return makeEnd<false>(views); }
+
+    auto end() const
+        requires(std::ranges::range<Views const> && ...)
+    {
+        return makeEnd<true>(views);
+    }
+
+    auto size()
+        requires detail::all_sized<false, Views...>
+    {
+        return shortest(views);
+    }
+
+    auto size() const
+        requires detail::all_sized<true, Views...>
+    {
+        return shortest(views);
+    }
+
+private:
+    template <bool Const, typename Tuple>
+    static auto makeBegin(Tuple& views) -> iterator<Const> {
+        return iterator<Const>(std::apply([](auto&... v) { return std::tuple(std::ranges::begin(v)...); }, views));
+    }
+
+    template <bool Const, typename Tuple>
+    static auto makeEnd(Tuple& views) {
+        if constexpr (detail::all_random_access<Const, Views...> && detail::all_sized<Const, Views...>) {
+            using difference_type = typename iterator<Const>::difference_type;
+            return makeBegin<Const>(views) + static_cast<difference_type>(shortest(views));
+        } else {
+            return sentinel<Const>(std::apply([](auto&... v) { return std::tuple(std::ranges::end(v)...); }, views));
+        }
+    }
+
+    template <typename Tuple>
+    static auto shortest(Tuple& views) {
+        return std::apply(
+            [](auto&... v) {
+                using size_type = std::common_type_t<decltype(std::ranges::size(v))...>;
+                return std::min({static_cast<size_type>(std::ranges::size(v))...});
+            },
+            views);
+    }
+
+    std::tuple<Views...> views;
+};
+
+template <typename... Ranges>
+zip_view(Ranges&&...) -> zip_view<std::views::all_t<Ranges>...>;
+
+// Zips ranges into a zip_view. Lvalue ranges are referenced, rvalue ranges are moved into the view.
+template <std::ranges::viewable_range... Ranges>
+auto zip(Ranges&&... ranges) {
+    return zip_view<std::views::all_t<Ranges>...>(std::views::all(std::forward<Ranges>(ranges))...);
+}
+
+// View over N ranges in lockstep that continues until the longest range ends. Its elements are
+// tuples of std::optional copies of the elements at each position, empty for ranges that have
+// already ended, since there is no element left to refer to.
+template <std::ranges::input_range... Views>
+    requires(std::ranges::view<Views> && ...) && (sizeof...(Views) > 0)
+class zip_longest_view : public std::ranges::view_interface<zip_longest_view<Views...>> {
+public:
+    class iterator {
+    public:
+        friend class zip_longest_view;
+
+        using iterator_concept = std::conditional_t<detail::all_forward<false, Views...>, std::forward_iterator_tag,
+                                                    std::input_iterator_tag>;
+        using iterator_category = iterator_concept;
+        using value_type = std::tuple<std::optional<std::ranges::range_value_t<Views>>...>;
+        using reference = value_type;
+        using difference_type = std::common_type_t<std::ranges::range_difference_t<Views>...>;
+
+        iterator() = default;
+
+        auto operator*() const -> value_type {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return value_type(element<I>()...);
+            }(std::index_sequence_for<Views...>());
+        }
+
+        auto operator++() -> iterator& {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((std::get<I>(current) != std::get<I>(ends) ? void(++std::get<I>(current)) : void()), ...);
+            }(std::index_sequence_for<Views...>());
+            return *this;
+        }
+
+        auto operator++(int) {
+            if constexpr (detail::all_forward<false, Views...>) {
+                auto temp = *this;
+                ++*this;
+                return temp;
+            } else {
+                ++*this;
+            }
+        }
+
+        friend auto operator==(iterator const& lhs, iterator const& rhs) -> bool
+            requires detail::all_forward<false, Views...>
+        {
+            return lhs.current == rhs.current;
+        }
+
+        friend auto operator==(iterator const& it, std::default_sentinel_t) -> bool {
+            return [&]<size_t... I>(std::index_sequence<I...>) {
+                return ((std::get<I>(it.current) == std::get<I>(it.ends)) && ...);
+            }(std::index_sequence_for<Views...>());
+        }
+
+    private:
+        using iterators = std::tuple<std::ranges::iterator_t<Views>...>;
+        using sentinels = std::tuple<std::ranges::sentinel_t<Views>...>;
+
+        iterator(iterators current, sentinels ends) : current(std::move(current)), ends(std::move(ends)) {}
+
+        template <size_t I>
+        auto element() const -> std::tuple_element_t<I, value_type> {
+            if (std::get<I>(current) == std::get<I>(ends)) return std::nullopt;
+            return *std::get<I>(current);
+        }
+
+        iterators current;
+        sentinels ends;
+    };
+
+    zip_longest_view() = default;
+    explicit zip_longest_view(Views... views) : views(std::move(views)...) {}
+
+    auto begin() -> iterator {
+        return std::apply(
+            [](auto&... v) { return iterator(std::tuple(std::ranges::begin(v)...), std::tuple(std::ranges::end(v)...)); },
+            views);
+    }
+
+    auto end() -> std::default_sentinel_t { return std::default_sentinel; }
+
+    auto size()
+        requires detail::all_sized<false, Views...>
+    {
+        return std::apply(
+            [](auto&... v) {
+                using size_type = std::common_type_t<decltype(std::ranges::size(v))...>;
+                return std::max({static_cast<size_type>(std::ranges::size(v))...});
+            },
+            views);
+    }
+
+private:
+    std::tuple<Views...> views;
+};
+
+template <typename... Ranges>
+zip_longest_view(Ranges&&...) -> zip_longest_view<std::views::all_t<Ranges>...>;
+
+// Zips ranges into a zip_longest_view. Lvalue ranges are referenced, rvalue ranges are moved into
+// the view.
+template <std::ranges::viewable_range... Ranges>
+auto zip_longest(Ranges&&... ranges) {
+    return zip_longest_view<std::views::all_t<Ranges>...>(std::views::all(std::forward<Ranges>(ranges))...);
+}
+
+}  // namespace xtd
+
+template <typename... Ts>
+struct std::tuple_size<xtd::zip_value<Ts...>> : std::integral_constant<std::size_t, sizeof...(Ts)> {};
+
+template <std::size_t I, typename... Ts>
+struct std::tuple_element<I, xtd::zip_value<Ts...>> : std::tuple_element<I, std::tuple<Ts...>> {};
+
+// The common reference of a tuple of references and a zip_value is the tuple of the common
+// references of their elements, where both convert to it.
+template <typename... Ts, typename... Us, template <typename> typename TQual, template <typename> typename UQual>
+    requires(sizeof...(Ts) == sizeof...(Us)) &&
+            std::convertible_to<UQual<xtd::zip_value<Us...>>, std::tuple<std::common_reference_t<TQual<Ts>, UQual<Us>>...>>
+struct std::basic_common_reference<std::tuple<Ts...>, xtd::zip_value<Us...>, TQual, UQual> {
+    using type = std::tuple<std::common_reference_t<TQual<Ts>, UQual<Us>>...>;
+};
+
+template <typename... Ts, typename... Us, template <typename> typename TQual, template <typename> typename UQual>
+    requires(sizeof...(Ts) == sizeof...(Us)) &&
+            std::convertible_to<TQual<xtd::zip_value<Ts...>>, std::tuple<std::common_reference_t<TQual<Ts>, UQual<Us>>...>>
+struct std::basic_common_reference<xtd::zip_value<Ts...>, std::tuple<Us...>, TQual, UQual> {
+    using type = std::tuple<std::common_reference_t<TQual<Ts>, UQual<Us>>...>;
+};
+
+template <typename... Views>
+inline constexpr bool std::ranges::enable_borrowed_range<xtd::zip_view<Views...>> =
+    (std::ranges::enable_borrowed_range<Views> && ...);
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "zip.hpp"
+
+namespace xtd {
+
+namespace detail {
+
+template <typename T, typename... Ranges>
+concept contiguous_arithmetic =
+    std::is_arithmetic_v<T> && ((std::ranges::contiguous_range<Ranges> && std::ranges::sized_range<Ranges> &&
+                                 std::is_arithmetic_v<std::ranges::range_value_t<Ranges>>) &&
+                                ...);
+
+// Independent partial results kept by the contiguous kernel: two 64 byte vectors' worth, so that
+// each vector add does not have to wait for the previous one to finish. The lanes are combined by
+// halving, so their number is rounded down to a power of two.
+template <typename T>
+inline constexpr std::size_t accumulators = std::bit_floor(std::max<std::size_t>(4, 2 * 64 / sizeof(T)));
+
+inline constexpr std::size_t vector_alignment = 64;
+
+}  // namespace detail
+
+// Returns init combined by reduce with transform(e1, ..., eN) for each row (e1, ..., eN) of
+// zip(ranges...), in unspecified order, like std::transform_reduce. reduce must therefore be
+// associative and commutative.
+//
+// When every range is a contiguous array of arithmetic values, and T is arithmetic, the rows are
+// reduced into a fixed block of accumulators, one per lane. Each lane only depends on itself, so the
+// compiler can vectorise the block without reassociating a single running total, which it may not
+// do for floating point without -ffast-math. Scalar iterations align the first range to a vector
+// boundary before the blocks start, and handle the remainder after them. Any other ranges go
+// through the generic zip loop.
+template <typename T, typename Reduce, typename Transform, std::ranges::input_range... Ranges>
+    requires(sizeof...(Ranges) > 0)
+auto zip_transform_reduce(T init, Reduce reduce, Transform transform, Ranges&&... ranges) -> T {
+    if constexpr (detail::contiguous_arithmetic<T, Ranges...>) {
+        auto const n = std::min({static_cast<std::size_t>(std::ranges::size(ranges))...});
+        auto const data = std::tuple(std::ranges::data(ranges)...);
+        auto const row = [&](std::size_t i) -> T {
+            return std::apply([&](auto const*... column) { return static_cast<T>(transform(column[i]...)); }, data);
+        };
+
+        std::size_t i = 0;
+        while (i < n && reinterpret_cast<std::uintptr_t>(std::get<0>(data) + i) % detail::vector_alignment != 0) {
+            init = reduce(init, row(i++));
+        }
+
+        constexpr auto width = detail::accumulators<T>;
+        if (n - i >= width) {
+            T lanes[width];
+            for (std::size_t j = 0; j < width; ++j) lanes[j] = row(i + j);
+            for (i += width; n - i >= width; i += width) {
+                for (std::size_t j = 0; j < width; ++j) lanes[j] = reduce(lanes[j], row(i + j));
+            }
+            for (auto half = width / 2; half > 0; half /= 2) {
+                for (std::size_t j = 0; j < half; ++j) lanes[j] = reduce(lanes[j], lanes[j + half]);
+            }
+            init = reduce(init, lanes[0]);
+        }
+
+        for (; i < n; ++i) init = reduce(init, row(i));
+        return init;
+    } else {
+        for (auto&& row : zip(std::forward<Ranges>(ranges)...)) init = reduce(std::move(init), std::apply(transform, row));
+        return init;
+    }
+}
+
+}  // namespace xtd